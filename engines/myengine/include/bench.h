@@ -15,6 +15,10 @@ struct BenchSettings {
     BenchMode searchMode = BenchMode::FIXED_DEPTH;
     int searchDepth = 9;
     int searchTimeMs = 1000;
+    // One thread, no book, and a fresh TT and history for every position, so
+    // a fixed-depth run always searches the same tree and the node signature
+    // only changes when the search does.
+    bool deterministic = true;
 };
 
 class Bench {
@@ -7,6 +7,8 @@
 #include <mutex>
 
 #include "move.h"
+#include "nnue.h"
+#include "psqt.h"
 #include "types.h"
 
 class Board {
@@ -34,14 +36,35 @@ public:
     bool isStalemate(Color color) const;
     bool isFiftyMoveDraw() const;
     bool isThreefoldRepetition() const;
+    // Search rule: a repeat of a position reached after the root (searchPly plies
+    // back or fewer) is a draw at once; earlier positions must occur twice.
+    bool isRepetition(int searchPly) const;
     bool isInsufficientMaterial() const;
 
+    // Knights, bishops, rooks or queens; the zugzwang guard for null-move pruning.
+    bool hasNonPawnMaterial(Color color) const;
+
+    // Squares a piece on square attacks through the given occupancy; colour
+    // only matters for pawns. Shared by check detection and evaluation.
+    static uint64_t attacksFrom(PieceIndex piece, int square, uint64_t occupied, Color colour = Color::WHITE);
+    static uint64_t pawnAttacks(Color colour, uint64_t pawns);
+
     uint64_t occupancy(Color color) const;
     uint64_t pieceBB(Color color, PieceIndex pieceIndex) const;
     Color sideToMove() const {return side_to_move;}
     PieceIndex getPieceAt(int square) const;
 
     uint64_t zobristKey() const {return current_zobrist_key;}
+    // Packed midgame/endgame material plus piece-square sum from white's side,
+    // kept up to date by makeMove/unmakeMove. Recomputed only by loadFEN after
+    // tables change.
+    Psqt::Score psqtScore() const {return psqt_score;}
+    // Sum of Psqt::PHASE_WEIGHT over all pieces, maintained the same way.
+    // Not capped: extra promoted pieces can push it past Psqt::MAX_PHASE.
+    int phaseMaterial() const {return phase_material;}
+    // First network layer for the current position. Only meaningful while
+    // a network is loaded; refreshed here if makeMove could not update it.
+    const Nnue::Accumulator& accumulator() const;
 
     int fullmoveNumber() const {return fullmove_number;}
     int enPassantSquare() const {return en_passant_square_index;}
@@ -59,6 +82,8 @@ private:
     int fullmove_number{};
 
     uint64_t current_zobrist_key{};
+    Psqt::Score psqt_score{};
+    int phase_material{};
 
     static uint64_t piece_keys[12][64];
     static uint64_t en_passant_keys[64];
@@ -72,6 +97,8 @@ private:
         int halfmove_clock;
         int fullmove_number;
         uint64_t zobrist_key;
+        Psqt::Score psqt_score;
+        int phase_material;
         Move move;
         PieceIndex moved_piece;
         PieceIndex captured_piece;
@@ -82,6 +109,16 @@ private:
     };
 
     std::vector<Undo> move_history;
+    // Key of the position before each move in move_history, kept contiguous
+    // so repetition scans don't stride over whole Undo records.
+    std::vector<uint64_t> key_history;
+    // One entry per ply, indexed by move_history.size(). makeMove only keeps
+    // them current while a network is loaded.
+    mutable std::vector<Nnue::Accumulator> accumulators;
+
+    // Count earlier occurrences of the current key, stopping at the last
+    // irreversible move or once maxCount is reached.
+    int countRepetitions(int maxCount) const;
 
     static bool inBounds(int squareIndex) {return squareIndex >= 0 && squareIndex < 64;}
     static void setBit(uint64_t& bitboard, int squareIndex) {bitboard |= (1ULL << squareIndex);}
@@ -91,6 +128,10 @@ private:
     bool isSquareAttacked(int squareIndex, Color attackingColor) const;
     int findKing(Color color) const;
     static uint64_t calculateZobristKey(const Board& board);
+    static Psqt::Score calculatePsqtScore(const Board& board);
+    static int calculatePhaseMaterial(const Board& board);
+    void refreshAccumulator(Nnue::Accumulator& acc) const;
+    void updateAccumulator(const Undo& undo);
 
     void printFENString() const;
     void printPseudoLegalMoves() const;
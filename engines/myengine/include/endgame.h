@@ -0,0 +1,29 @@
+#pragma once
+
+#include "board.h"
+
+// Specialized evaluation for endings the general terms misjudge: a lone king
+// against mating material (boxed in, pushed to the edge and approached),
+// KBNK (pushed to the bishop's corner), KPK (exact, from a bitbase), KRKP,
+// KRKB, KRKN and the drawn KNNK. Endings are picked by material signature and
+// checked before the handcrafted or network evaluation.
+namespace Endgame {
+
+// Above any ordinary material balance and well below the mate range, so a won
+// specialized ending ranks under a mate the search has actually found.
+constexpr int KNOWN_WIN = 10000;
+
+// Score for the side to move if a specialized evaluator covers the position;
+// false for everything else, which is nearly every position and is decided
+// from the piece count alone.
+bool probe(const Board& board, int& score);
+
+// Builds the KPK bitbase, which takes tens of milliseconds. The engine calls
+// it at startup so no search pays for it; otherwise the first lookup does.
+void init();
+
+// KPK bitbase: true if the side with the pawn wins. Squares are given as if
+// that side were white (a1 = 0).
+bool kpkWin(int strongKing, int pawn, int weakKing, bool strongToMove);
+
+} // namespace Endgame
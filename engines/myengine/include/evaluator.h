@@ -1,45 +1,72 @@
 #pragma once
 
 #include "board.h"
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
+// An Evaluator holds only its settings, so a copy per thread costs nothing.
+// The values it reads are not per instance: material and piece-square
+// tables live in the process-wide Psqt::tables, because Board's running
+// psqtScore is summed from the same tables.
 class Evaluator {
 public:
     static constexpr int PST_COUNT = 6;
 
-    Evaluator();
+    Evaluator() = default;
 
     int evaluate(const Board& board, Color side_to_move) const;
+
+    // Stand-pat variant, for the side to move against the window
+    // (alpha, beta). When material and PST alone sit more than LAZY_MARGIN
+    // outside the window, the activity terms are skipped and *lazy is set;
+    // the result is then only a bound on the same side of the window
+    // (>= beta or <= alpha), not a score. Always exact with a network loaded.
+    // LAZY_MARGIN is a heuristic, not a proven bound: the activity terms can
+    // in principle sum to more, and then the lazy result is on the wrong side.
+    // The largest activity sum seen over kiwipete and the bench positions,
+    // three plies deep, is about 260, so 350 leaves some slack. Re-check it
+    // after retuning the activity weights.
+    static constexpr int LAZY_MARGIN = 350;
+    int evaluate(const Board& board, int alpha, int beta, bool* lazy = nullptr) const;
     static int evaluateTerminal(const Board& board, Color side_to_move);
 
-private:
-    int evaluateMaterial(const Board& board) const;
-    int evaluatePositional(const Board& board) const;
+    // evaluate(boards[i], Color::WHITE) for count boards at once, for
+    // labeling and tuning runs. Only the material/PST taper is vectorized:
+    // the activity terms and Endgame::probe still run board by board, and
+    // they dominate the cost, so expect little over the scalar path.
+    void evaluateBatch(const Board* boards, std::size_t count, int* scores) const;
 
-    int pieceValues[PST_COUNT] = {100, 320, 330, 500, 900, 20000};
+    // Psqt::MAX_PHASE with every minor and major piece on the board, 0 with none.
+    static int gamePhase(const Board& board);
 
-    // For Texel Tuning
+    // For Texel Tuning: the midgame block (6 piece values, 6 tables, then the
+    // mobility, king-attack and threat weights), followed by the same for the
+    // endgame. Every parameter is process-wide (Psqt::tables and the activity
+    // weights), so setParameter changes all Evaluators at once: call it only
+    // while no search is running. Boards keep the old material + PST sum
+    // until reloaded, and TT entries keep old static evals until
+    // TranspositionTable::clear(). Values are stored as int16_t; setParameter
+    // returns false and changes nothing for an index or value out of range.
     int getParameterCount() const;
     int getParameter(int index) const;
-    void setParameter(int index, int value);
-    void updateBlackTables();
-
-    std::vector<int> whitePawnTable;
-    std::vector<int> whiteKnightTable;
-    std::vector<int> whiteBishopTable;
-    std::vector<int> whiteRookTable;
-    std::vector<int> whiteQueenTable;
-    std::vector<int> whiteKingTableMG;
-    std::vector<int> whiteKingTableEG;
-
-    std::vector<int> blackPawnTable;
-    std::vector<int> blackKnightTable;
-    std::vector<int> blackBishopTable;
-    std::vector<int> blackRookTable;
-    std::vector<int> blackQueenTable;
-    std::vector<int> blackKingTableMG;
-    std::vector<int> blackKingTableEG;
-
-    void initializePieceSquareTables();
+    bool setParameter(int index, int value);
+
+    // Outside the specialized endgames (Endgame::probe), the handcrafted
+    // evaluation is linear in its parameters: before the phase blend, the
+    // midgame score from white's side is the sum of value *
+    // getParameter(index) over these coefficients, and the endgame score is
+    // the same with every index offset by getParameterCount() / 2.
+    struct Coefficient {
+        int index;   // into the midgame block
+        int value;
+    };
+    void getCoefficients(const Board& board, std::vector<Coefficient>& out) const;
+
+    // Endgame::probe runs before the general evaluation unless turned off,
+    // which lets tests look at the general terms on bare-king positions.
+    void setSpecializedEndgames(bool enabled) { specializedEndgames_ = enabled; }
+
+private:
+    bool specializedEndgames_ = true;
 };
@@ -2,9 +2,12 @@
 #include "board.h"
 #include "book.h"
 #include "evaluator.h"
+#include "nnue.h"
 #include "search.h"
 #include "transpositionTable.h"
 #include "timeManager.h"
+#include <functional>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -14,6 +17,10 @@ struct PlaySettings {
     int increment_ms;
     int moves_to_go;
     int movetime_ms;  // 0 = unset; >0 = UCI 'go movetime' fixed budget
+    bool infinite;    // UCI 'go infinite': search until stop
+    bool ponder;      // UCI 'go ponder': search on the opponent's time until ponderhit/stop
+    uint64_t nodes;   // UCI 'go nodes N': node budget (0 = none)
+    int mate;         // UCI 'go mate N': stop once a mate in N is found (0 = off)
 };
 
 struct BenchSettings;
@@ -24,10 +31,23 @@ public:
     ~Engine();
 
     void reset();
+    void newGame();
     bool setPosition(const std::string &fen);
 
     std::string playMove(const PlaySettings &settings);
 
+    // Asynchronous search for the UCI loop. onBestMove runs on the search
+    // thread with the chosen move and the expected reply (empty if unknown).
+    using BestMoveCallback = std::function<void(const std::string& best, const std::string& ponder)>;
+    void startSearch(const PlaySettings &settings, BestMoveCallback onBestMove);
+    void stopSearch();
+    void ponderhit();
+    void waitForSearch();
+
+    // Progress reporting for startSearch(); synchronous playMove() stays quiet.
+    void setInfoCallback(Search::InfoCallback cb) { info_callback = std::move(cb); }
+    void setCurrMoveCallback(Search::CurrMoveCallback cb) { currmove_callback = std::move(cb); }
+
     std::string getFEN() const;
     int evaluateCurrentPosition();
     bool applyMove(const std::string &uci);
@@ -40,10 +60,26 @@ public:
 
     bool loadOpeningBook(const std::string& path) { return opening_book.load(path); }
     void setUseBook(bool on) { use_book = on; }
+    bool usesBook() const { return use_book; }
     void setBookMaxFullmove(int n) { book_max_fullmove = n; }
     int bookMaxFullmove() const { return book_max_fullmove; }
 
+    // Network for the evaluator; without one it uses the piece-square tables.
+    // Switching evaluator clears the TT, whose scores came from the old one.
+    bool loadEvalFile(const std::string& path);
+    void clearEvalFile();
+
+    void setThreads(int n) { searcher.setThreadCount(n); }
+    int threads() const { return searcher.getThreadCount(); }
+    void setMultiPV(int n) { searcher.setMultiPV(n); }
+    int multiPV() const { return searcher.getMultiPV(); }
+    void setRootSplit(bool on) { searcher.setRootSplit(on); }
+    void setSearchParams(const SearchParams& p) { searcher.setParams(p); }
+    const SearchParams& searchParams() const { return searcher.getParams(); }
+
 private:
+    std::string runSearch(const PlaySettings &settings, bool report);
+
     Board board;
     std::vector<std::string> history;
 
@@ -58,5 +94,10 @@ private:
     bool use_book = true;
     int book_max_fullmove = 20;
 
+    std::thread search_thread;
+    std::string last_ponder_move;
+    Search::InfoCallback info_callback;
+    Search::CurrMoveCallback currmove_callback;
+
     friend class Bench;
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Optional efficiently-updatable network: 768 piece-square inputs seen from
+// each side, one hidden layer of HIDDEN clipped-ReLU units per perspective,
+// one output. With no network loaded the engine uses the Psqt evaluation.
+//
+// Board keeps one Accumulator per ply (the first layer's output for both
+// perspectives) and updates it from the pieces a move adds and removes, so
+// evaluation only runs the small output layer.
+namespace Nnue {
+
+constexpr int INPUTS = 768;
+constexpr int HIDDEN = 128;
+
+// Quantization: hidden activations are clipped to [0, QA], output weights are
+// scaled by QB, and the result is mapped to centipawns with OUTPUT_SCALE.
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int OUTPUT_SCALE = 400;
+
+// Kept well clear of the mate range.
+constexpr int MAX_EVAL = 30000;
+
+struct alignas(64) Accumulator {
+    int16_t values[2][HIDDEN];   // [perspective: 0 white, 1 black]
+    // Network the values were computed for (see generation()); anything else
+    // means they are stale and must be refreshed.
+    uint32_t generation = 0;
+};
+
+// Pieces a move removes and adds: at most two of each (castling, or a
+// capture that promotes).
+struct DirtyPieces {
+    struct Piece {
+        int colour;
+        int piece;
+        int square;
+    };
+    Piece removed[2];
+    Piece added[2];
+    int removedCount = 0;
+    int addedCount = 0;
+
+    void remove(int colour, int piece, int square) { removed[removedCount++] = {colour, piece, square}; }
+    void add(int colour, int piece, int square) { added[addedCount++] = {colour, piece, square}; }
+};
+
+// Reads a network file ("MYNN", version, hidden size, then little-endian
+// weights; see nnue.cpp). On failure the previous network, if any, stays
+// loaded. Not safe to call while a search is running.
+bool load(const std::string& path);
+void unload();
+
+// Nonzero while a network is loaded; changes on every successful load.
+uint32_t generation();
+inline bool isLoaded() { return generation() != 0; }
+
+// Building blocks for Board: refresh is reset() followed by addPiece() for
+// every piece on the board; update() derives a child accumulator from its
+// parent and the pieces one move changed.
+void reset(Accumulator& acc);
+void addPiece(Accumulator& acc, int colour, int piece, int square);
+void update(const Accumulator& parent, Accumulator& child, const DirtyPieces& dirty);
+
+// Score in centipawns for the side to move (0 white, 1 black). Uses AVX2 or
+// SSE2 when the build enables them; evaluateScalar is the plain reference.
+int evaluate(const Accumulator& acc, int sideToMove);
+int evaluateScalar(const Accumulator& acc, int sideToMove);
+
+} // namespace Nnue
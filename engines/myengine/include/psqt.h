@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+// Material and piece-square values. Board keeps a running sum of them
+// (Board::psqtScore), so evaluation does not rescan the bitboards.
+namespace Psqt {
+
+constexpr int PIECE_TYPES = 6;
+constexpr int MG = 0;
+constexpr int EG = 1;
+
+// Midgame and endgame halves packed into one int, so a single add updates
+// both. The endgame half sits in the upper 16 bits; each half must stay
+// within int16 range.
+using Score = int32_t;
+
+constexpr Score makeScore(int mg, int eg) {
+    return static_cast<Score>(static_cast<uint32_t>(eg) << 16) + mg;
+}
+
+constexpr int mgValue(Score s) {
+    return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(s)));
+}
+
+constexpr int egValue(Score s) {
+    return static_cast<int16_t>(static_cast<uint16_t>((static_cast<uint32_t>(s) + 0x8000) >> 16));
+}
+
+// Game phase from non-pawn material: 24 with all minor and major pieces on
+// the board, 0 with none.
+constexpr int PHASE_WEIGHT[PIECE_TYPES] = {0, 1, 1, 2, 4, 0};
+constexpr int MAX_PHASE = 24;
+
+// Everything is stored once, from white's side with a1 = 0; black reads the
+// same entries at square ^ 56. About 3 KB in one aligned block.
+struct alignas(64) Tables {
+    // Packed material + PST per [piece][square], derived from the arrays
+    // below by rebuild(). King material is left out: both kings are always
+    // present, and 20000 would not fit.
+    Score combined[PIECE_TYPES][64];
+    int16_t pieceSquare[2][PIECE_TYPES][64];   // [MG/EG][piece][square]
+    int16_t pieceValue[2][PIECE_TYPES];        // [MG/EG][piece]
+};
+
+// Built at compile time.
+extern const Tables DEFAULT_TABLES;
+
+// Starts as a copy of DEFAULT_TABLES, constant-initialized, so it is usable
+// from other static initializers. Process-wide and read without locks by
+// every search thread, so it may only change while none is running. After
+// editing, call rebuild() and reload every Board: their running psqtScore
+// was summed from the old values.
+extern Tables tables;
+
+void rebuild();
+void resetToDefaults();
+
+// Signed contribution of one piece; colour is 0 for white, 1 for black.
+inline Score value(int colour, int piece, int square) {
+    return colour == 0 ? tables.combined[piece][square] : -tables.combined[piece][square ^ 56];
+}
+
+// Midgame/endgame blend of a packed score for the given phase.
+inline int taper(Score s, int phase) {
+    return (mgValue(s) * phase + egValue(s) * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+} // namespace Psqt
@@ -8,17 +8,132 @@
 #include <vector>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <functional>
 #include <cstring>
+#include <algorithm>
+#include <iterator>
+
+struct SearchLimits {
+    int depth = 64;
+    int timeLeftMs = 0;
+    int incrementMs = 0;
+    int movesToGo = 0;
+    int movetimeMs = 0;
+    bool infinite = false;  // ignore the clock; run until stop()
+    uint64_t nodes = 0;     // stop once this many nodes are searched (0 = no limit)
+    int mate = 0;           // stop once a mate in this many moves is proven or ruled out (0 = off)
+};
+
+// Progress report for one completed iteration (UCI "info depth ...").
+struct SearchInfo {
+    int depth = 0;
+    int multiPV = 1;  // 1-based rank of this line
+    int selDepth = 0;
+    int score = 0;
+    uint64_t nodes = 0;
+    uint64_t timeMs = 0;
+    int hashfull = 0;
+    std::vector<Move> pv;
+};
+
+// Tunable search constants, exposed as UCI spin options for SPRT testing.
+// Fractional terms are stored in hundredths.
+struct SearchParams {
+    int lmrBase = 75;               // reduction = base + ln(depth) * ln(moveNumber) / divisor
+    int lmrDivisor = 225;
+    int lmrMinDepth = 3;
+    int lmrMinMoves = 3;            // moves searched at full depth before reducing
+    int lmrHistoryDivisor = 4096;   // one ply less reduction per this much history
+
+    // Static-eval pruning near the leaves (margins in centipawns).
+    int rfpMaxDepth = 7;            // reverse futility: eval - margin * depth >= beta
+    int rfpMargin = 80;
+    int razorMaxDepth = 3;          // razoring: eval + margin * depth < alpha drops to q-search
+    int razorMargin = 300;
+    int futilityMaxDepth = 6;       // futility: skip quiets when eval + base + margin * depth <= alpha
+    int futilityBase = 100;
+    int futilityMargin = 100;
+    int lmpMaxDepth = 5;            // late move pruning: skip quiets past 3 + depth^2 moves (x2 if improving)
+
+    // Extensions. Each root-to-leaf path may gain at most maxExtensions plies.
+    int maxExtensions = 16;
+    int singularMinDepth = 8;       // TT move is singular if all others fail below ttValue - margin * depth
+    int singularMargin = 2;
+
+    int iirMinDepth = 4;            // nodes without a TT move lose a ply from this depth
+};
 
 class Search {
 public:
+    static constexpr int MATE_SCORE = 100000;
+    static constexpr int MAX_PLY = 128;
+
+    using InfoCallback = std::function<void(const SearchInfo&)>;
+    using CurrMoveCallback = std::function<void(int depth, const Move& move, int moveNumber)>;
+
     Search(const Evaluator& evaluator, TranspositionTable& tt);
+    ~Search();
+
+    Search(const Search&) = delete;
+    Search& operator=(const Search&) = delete;
 
     Move findBestMove(Board& board, int maxDepth, int timeLeftMs = 0, int incrementMs = 0, int movesToGo = 0, int movetimeMs = 0);
 
+    // Does not clear a pending stop(): callers searching on another thread
+    // call resetSignals() before handing off, so an early stop is not lost.
+    // Infinite and ponder searches hold their result until stop()/ponderhit().
+    Move findBestMove(Board& board, const SearchLimits& limits);
+
+    void resetSignals(bool ponder = false);
+    void stop();
+    void ponderhit();
+
+    // Both run on the searching thread, so they must not block on I/O.
+    // currmove is only reported once an iteration has taken a while.
+    void setInfoCallback(InfoCallback cb) { infoCallback_ = std::move(cb); }
+    void setCurrMoveCallback(CurrMoveCallback cb) { currMoveCallback_ = std::move(cb); }
+
+    // Opponent reply expected after the last returned best move (from the TT),
+    // or an invalid move if none is known.
+    Move getPonderMove() const { return ponderMove_; }
+
+    // Resizes the persistent helper pool. Threads are parked between searches.
     void setThreadCount(int count);
     int getThreadCount() const { return numThreads_; }
 
+    // Root splitting: instead of Lazy SMP, all threads take root moves from a
+    // shared index once the first move has set alpha. Faster answers at low
+    // depth; used only with more than one thread and a single PV line.
+    void setRootSplit(bool on) { rootSplit_ = on; }
+    bool getRootSplit() const { return rootSplit_; }
+
+    // Number of ranked root lines searched and reported per iteration.
+    void setMultiPV(int lines);
+    int getMultiPV() const { return multiPV_; }
+
+    struct RootLine {
+        Move move;
+        int score;
+    };
+
+    // Ranked lines from the last completed iteration, best first.
+    const std::vector<RootLine>& getRootLines() const { return rootLines_; }
+
+    // Replaces the tunables and rebuilds the derived reduction table.
+    // Must not be called while a search is running.
+    void setParams(const SearchParams& params);
+    const SearchParams& getParams() const { return params_; }
+
+    // Base late-move reduction in plies, before per-move adjustments.
+    int lateMoveReduction(int depth, int moveNumber) const;
+
+    // Forget move-ordering history (e.g. on ucinewgame). History otherwise
+    // persists across findBestMove calls.
+    void clearHistory();
+
     struct SearchStats {
         long long totalNodes = 0;
         long long qNodes = 0;
@@ -26,6 +141,18 @@ public:
         long long ttProbes = 0;
         long long betaCutoffs = 0;
         long long firstMoveCutoffs = 0;
+        long long rfpPrunes = 0;
+        long long razorPrunes = 0;
+        long long futilityPrunes = 0;
+        long long lmpPrunes = 0;
+        long long deltaPrunes = 0;
+        long long checkExtensions = 0;
+        long long singularExtensions = 0;
+        long long recaptureExtensions = 0;
+        long long evalCacheProbes = 0;
+        long long evalCacheHits = 0;
+        long long lazyEvalProbes = 0;   // stand-pat evaluations given a window
+        long long lazyEvalSkips = 0;    // ... answered without the activity terms
 
         void operator+=(const SearchStats& other) {
             totalNodes += other.totalNodes;
@@ -34,6 +161,18 @@ public:
             ttProbes += other.ttProbes;
             betaCutoffs += other.betaCutoffs;
             firstMoveCutoffs += other.firstMoveCutoffs;
+            rfpPrunes += other.rfpPrunes;
+            razorPrunes += other.razorPrunes;
+            futilityPrunes += other.futilityPrunes;
+            lmpPrunes += other.lmpPrunes;
+            deltaPrunes += other.deltaPrunes;
+            checkExtensions += other.checkExtensions;
+            singularExtensions += other.singularExtensions;
+            recaptureExtensions += other.recaptureExtensions;
+            evalCacheProbes += other.evalCacheProbes;
+            evalCacheHits += other.evalCacheHits;
+            lazyEvalProbes += other.lazyEvalProbes;
+            lazyEvalSkips += other.lazyEvalSkips;
         }
 
         void reset() {
@@ -43,6 +182,18 @@ public:
             ttProbes = 0;
             betaCutoffs = 0;
             firstMoveCutoffs = 0;
+            rfpPrunes = 0;
+            razorPrunes = 0;
+            futilityPrunes = 0;
+            lmpPrunes = 0;
+            deltaPrunes = 0;
+            checkExtensions = 0;
+            singularExtensions = 0;
+            recaptureExtensions = 0;
+            evalCacheProbes = 0;
+            evalCacheHits = 0;
+            lazyEvalProbes = 0;
+            lazyEvalSkips = 0;
         }
     };
 
@@ -52,28 +203,128 @@ public:
     uint64_t getNodes() const { return aggregateStats_.totalNodes; }
 
 private:
+    // Per-ply search state. Entry [ply] describes the node at that ply; the
+    // parent fills in what it already knows (in-check, move count) before recursing.
+    struct SearchStack {
+        Move currentMove;        // move being searched from this node
+        Move excludedMove;       // singular-extension search skips this move
+        Move killers[2];
+        int staticEval = 0;      // -INF when in check; feeds the improving heuristic
+        int extensions = 0;      // extension plies accumulated on the path to this node
+        bool inCheck = false;
+    };
+
+    // Static evaluations by Zobrist key, one slot per index, newest wins.
+    static constexpr size_t EVAL_CACHE_SIZE = 1 << 14;
+    struct EvalCacheEntry {
+        uint64_t key = 0;
+        int eval = 0;
+    };
+
+    // Long-lived per-thread state. workers_[0] belongs to the thread calling
+    // findBestMove; workers_[i] (i > 0) to the parked helper threads_[i - 1].
     struct WorkerState {
         SearchStats stats;
         int history[2][64][64];
+        SearchStack stack[MAX_PLY + 1];
+        // Cleared at the start of every search, so evaluator changes between
+        // searches (EvalFile, tuned tables) never serve a stale score.
+        EvalCacheEntry evalCache[EVAL_CACHE_SIZE];
+        Board board;
+        int selDepth = 0;
+        // Null moves are disabled below this ply while a verification search runs.
+        int nmpMinPly = 0;
+        // Node count visible to other threads; refreshed every few thousand nodes.
+        std::atomic<uint64_t> publishedNodes{0};
+
+        void publishNodes() {
+            publishedNodes.store(static_cast<uint64_t>(stats.totalNodes), std::memory_order_relaxed);
+        }
 
         void reset() {
             stats.reset();
             std::memset(history, 0, sizeof(history));
+            for (auto& ss : stack) ss = SearchStack{};
+            clearEvalCache();
+        }
+
+        void clearEvalCache() {
+            std::fill(std::begin(evalCache), std::end(evalCache), EvalCacheEntry{});
         }
     };
 
+    // One root-split iteration. The main thread fills it in before waking the
+    // helpers; after that moves are claimed through nextMove and the best
+    // result is updated under the mutex.
+    struct RootSplit {
+        std::vector<Move> moves;
+        int depth = 0;
+        std::atomic<size_t> nextMove{0};
+        std::atomic<int> alpha{0};
+        std::mutex mutex;
+        Move bestMove;
+        int bestScore = 0;
+    };
+
     const Evaluator& evaluator_;
     TranspositionTable& tt_;
     TimeManager tm_;
     std::atomic<bool> stopFlag_{false};
-    int numThreads_;
+    std::atomic<bool> pondering_{false};
+    bool infinite_ = false;
+    std::mutex signalMutex_;
+    std::condition_variable signalCv_;
+    Move ponderMove_;
+    int multiPV_ = 1;
+    bool rootSplit_ = false;
+    RootSplit split_;
+    uint64_t nodeLimit_ = 0;
+    SearchParams params_;
+    int lmrTable_[64][64];
+    std::vector<RootLine> rootLines_;
+    InfoCallback infoCallback_;
+    CurrMoveCallback currMoveCallback_;
+    int numThreads_ = 0;
     SearchStats aggregateStats_;
 
+    std::vector<std::unique_ptr<WorkerState>> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex poolMutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable doneCv_;
+    uint64_t searchGeneration_ = 0;
+    int busyHelpers_ = 0;
+    int jobMaxDepth_ = 0;
+    bool jobRootSplit_ = false;
+    bool exiting_ = false;
+
     bool shouldStop() const;
+    bool ignoresClock() const { return infinite_ || pondering_.load(std::memory_order_relaxed); }
+    void waitForStopOrPonderhit();
+    std::vector<Move> extractPV(Board& board, const Move& bestMove, int maxLength) const;
+    uint64_t nodesSearched() const;
+    uint64_t publishedNodes() const;
+    void reportIteration(Board& board, int depth, int multiPV, int score, const Move& bestMove) const;
+
+    void idleLoop(int threadId, uint64_t seenGeneration);
+    void startHelpers(const Board& board, int maxDepth, bool rootSplit = false);
+    void waitForHelpers();
+    void shutdownPool();
 
-    void helperThreadMain(WorkerState& ws, Board board, int maxDepth, int threadId);
+    void helperThreadMain(WorkerState& ws, int maxDepth, int threadId);
+    int searchRoot(WorkerState& ws, Board& board, std::vector<Move>& moves, int depth,
+                   const std::vector<Move>& excluded, Move& bestMove, bool isMainThread);
+    int searchRootSplit(WorkerState& ws, Board& board, const std::vector<Move>& moves, int depth, Move& bestMove);
+    void splitRootMoves(WorkerState& ws, Board& board);
 
+    // A node with stack[ply].excludedMove set is a singular-extension search; it
+    // uses its own TT key so it never overwrites the real entry.
     int negamax(WorkerState& ws, Board& board, int depth, int alpha, int beta, int plyFromRoot);
     int quiescence(WorkerState& ws, Board& board, int alpha, int beta, int plyFromRoot);
-    void orderMoves(const WorkerState& ws, Board& board, std::vector<Move>& moves, const Move& ttMove);
+    // Evaluator score for the side to move, through the worker's eval cache.
+    int staticEvaluation(WorkerState& ws, const Board& board) const;
+    // Same for a stand-pat test against (alpha, beta); a cache miss may come
+    // back as the evaluator's lazy bound, which sets lazy and is not cached.
+    int staticEvaluation(WorkerState& ws, const Board& board, int alpha, int beta, bool& lazy) const;
+    void orderMoves(const WorkerState& ws, Board& board, std::vector<Move>& moves, const Move& ttMove, int plyFromRoot);
 };
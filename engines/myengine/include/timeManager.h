@@ -44,13 +44,18 @@ public:
      * Search calls this after each completed iterative-deepening depth.
      * Stable best move (>= STABLE_THRESHOLD repeats) shrinks the soft
      * deadline; a changed best move extends it (still capped by hard).
+     * No-op after startFixed(): a fixed movetime is never rescaled.
      */
     void onIterationComplete(bool best_move_changed);
 
+    /** Milliseconds since the last start()/startFixed(). */
+    uint64_t elapsedMs() const;
+
 private:
     std::chrono::steady_clock::time_point start_time_{};
     std::chrono::milliseconds soft_alloc_{0};
     std::chrono::milliseconds hard_alloc_{0};
     double soft_scale_{1.0};
     int stable_count_{0};
+    bool fixed_{false};
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <climits>
 #include <vector>
 #include "move.h"
 
@@ -9,6 +10,7 @@ public:
     static constexpr int EXACT = 0;
     static constexpr int LOWERBOUND = 1;
     static constexpr int UPPERBOUND = 2;
+    static constexpr int NO_EVAL = INT_MIN;
 
     struct TTEntry {
         uint64_t key;
@@ -16,16 +18,21 @@ public:
         Move bestMove;
         int depth;
         int flag;
+        int staticEval;  // NO_EVAL if the node was in check or never evaluated
     };
 
     TranspositionTable(size_t sizeInMB = 1024);
 
     void clear();
 
-    void store(uint64_t key, int value, int depth, Move bestMove, int flag);
+    // A NO_EVAL staticEval keeps the eval already cached for the same key.
+    void store(uint64_t key, int value, int depth, Move bestMove, int flag, int staticEval = NO_EVAL);
 
     bool probe(uint64_t key, TTEntry& out) const;
 
+    // Occupancy in permille, sampled from the first 1000 slots (UCI "hashfull").
+    int hashfull() const;
+
 private:
     std::vector<TTEntry> table_;
     size_t numEntries_;
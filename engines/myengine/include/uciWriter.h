@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Line-oriented output queue drained by its own thread. send() only takes a
+// short lock, so a search thread reporting progress never stalls on a slow
+// or full stdout pipe. Lines are written in the order they were sent.
+class UciWriter {
+public:
+    explicit UciWriter(std::ostream& out);
+    ~UciWriter();
+
+    UciWriter(const UciWriter&) = delete;
+    UciWriter& operator=(const UciWriter&) = delete;
+
+    // Queues one line; the newline is appended by the writer.
+    void send(std::string line);
+
+    // Blocks until every queued line has been written and flushed.
+    void flush();
+
+private:
+    void run();
+
+    std::ostream& out_;
+    std::mutex mutex_;
+    std::condition_variable pendingCv_;
+    std::condition_variable drainedCv_;
+    std::deque<std::string> queue_;
+    bool writing_ = false;
+    bool exiting_ = false;
+    std::thread thread_;
+};
@@ -29,6 +29,10 @@ void Bench::run(Engine& engine, const BenchSettings& settings) {
 void Bench::benchmarkEval(Engine& engine, int durationMs) {
     std::cout << "[Running Eval Throughput Test (" << durationMs << "ms)]\n";
 
+    // Positions are parsed once; the loop measures evaluate() alone.
+    std::vector<Board> boards;
+    for (const auto& fen : BENCH_FENS) boards.emplace_back(fen);
+
     long long count = 0;
     auto start = std::chrono::high_resolution_clock::now();
 
@@ -37,10 +41,11 @@ void Bench::benchmarkEval(Engine& engine, int durationMs) {
         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() > durationMs)
             break;
 
-        for (const auto& fen : BENCH_FENS) {
-            engine.setPosition(fen);
-            volatile int score = engine.evaluator.evaluate(engine.board, engine.board.sideToMove());
-            count++;
+        for (int i = 0; i < 1000; ++i) {
+            for (const auto& board : boards) {
+                volatile int score = engine.evaluator.evaluate(board, board.sideToMove());
+                count++;
+            }
         }
     }
 
@@ -50,12 +55,37 @@ void Bench::benchmarkEval(Engine& engine, int durationMs) {
     std::cout << "Total Evals: " << count << "\n";
     std::cout << "Time:        " << duration << "s\n";
     std::cout << "EPS:         " << (long long)(count / (duration + 0.0001)) << " (Evals Per Second)\n";
+
+    // Same positions through evaluateBatch, laid out the way a labeling run
+    // would pass them: one large contiguous array.
+    std::vector<Board> batch;
+    for (int i = 0; i < 1024; ++i) batch.push_back(boards[i % boards.size()]);
+    std::vector<int> scores(batch.size());
+
+    long long batchCount = 0;
+    start = std::chrono::high_resolution_clock::now();
+    while (true) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() > durationMs)
+            break;
+
+        for (int i = 0; i < 100; ++i) {
+            engine.evaluator.evaluateBatch(batch.data(), batch.size(), scores.data());
+            batchCount += static_cast<long long>(batch.size());
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / 1000.0;
+
+    std::cout << "Batch EPS:   " << (long long)(batchCount / (duration + 0.0001)) << " (Evals Per Second, "
+              << batch.size() << " per call, taper vectorized, activity and endgames scalar)\n";
 }
 
 void Bench::benchmarkSearch(Engine& engine, const BenchSettings& config) {
     std::string modeStr = (config.searchMode == BenchMode::FIXED_DEPTH)
                               ? "Fixed Depth: " + std::to_string(config.searchDepth)
                               : "Fixed Time: " + std::to_string(config.searchTimeMs) + "ms";
+    if (config.deterministic) modeStr += ", 1 thread, fresh TT";
 
     std::cout << "[Running Search Test - " << modeStr << "]\n";
     std::cout << "----------------------------------------------------------------------\n";
@@ -63,13 +93,22 @@ void Bench::benchmarkSearch(Engine& engine, const BenchSettings& config) {
         << std::setw(12) << "Nodes"
         << std::setw(10) << "Time(s)"
         << std::setw(10) << "NPS"
-        << std::setw(10) << "Ordering%" << "\n";
-    std::cout << "----------------------------------------------------------------------\n";
+        << std::setw(11) << "Ordering%"
+        << std::setw(10) << "QLoad%" << "\n";
+    std::cout << "--------------------------------------------------------------------------------\n";
 
     Search::SearchStats cumulativeStats;
     long long totalTimeMs = 0;
 
+    const int savedThreads = engine.threads();
+    const bool savedBook = engine.usesBook();
+    if (config.deterministic) {
+        engine.setThreads(1);
+        engine.setUseBook(false);
+    }
+
     for (const auto& fen : BENCH_FENS) {
+        if (config.deterministic) engine.newGame();
         engine.setPosition(fen);
         engine.searcher.resetStats();
 
@@ -100,15 +139,23 @@ void Bench::benchmarkSearch(Engine& engine, const BenchSettings& config) {
             ordering = (double)currentStats.firstMoveCutoffs / currentStats.betaCutoffs * 100.0;
         }
 
+        double qLoad = (double)currentStats.qNodes / (currentStats.totalNodes + 1) * 100.0;
+
         std::string shortFen = fen.substr(0, 25) + "...";
         std::cout << std::left << std::setw(30) << shortFen
             << std::setw(12) << currentStats.totalNodes
             << std::setw(10) << std::fixed << std::setprecision(3) << (ms / 1000.0)
             << std::setw(10) << (long long)(currentStats.totalNodes / (ms / 1000.0 + 0.0001))
-            << std::setw(9) << std::setprecision(1) << ordering << "%\n";
+            << std::setw(9) << std::setprecision(1) << ordering << "% "
+            << std::setw(9) << qLoad << "%\n";
     }
 
-    std::cout << "----------------------------------------------------------------------\n";
+    std::cout << "--------------------------------------------------------------------------------\n";
+
+    if (config.deterministic) {
+        engine.setThreads(savedThreads);
+        engine.setUseBook(savedBook);
+    }
 
     double totalSeconds = totalTimeMs / 1000.0;
 
@@ -128,5 +175,27 @@ void Bench::benchmarkSearch(Engine& engine, const BenchSettings& config) {
     double ttHitRate = (double)cumulativeStats.ttHits / (cumulativeStats.totalNodes + 1) * 100.0;
     std::cout << "TT Hit Rate:      " << std::setprecision(1) << ttHitRate << "%\n";
 
+    double evalCacheHitRate = (double)cumulativeStats.evalCacheHits / (cumulativeStats.evalCacheProbes + 1) * 100.0;
+    std::cout << "Eval Cache Hits:  " << std::setprecision(1) << evalCacheHitRate << "% (of "
+              << cumulativeStats.evalCacheProbes << " static evals)\n";
+
+    double lazySkipRate = (double)cumulativeStats.lazyEvalSkips / (cumulativeStats.lazyEvalProbes + 1) * 100.0;
+    std::cout << "Lazy Eval Skips:  " << std::setprecision(1) << lazySkipRate << "% (of "
+              << cumulativeStats.lazyEvalProbes << " stand-pat evals)\n";
+
+    std::cout << "Pruned (RFP/Razor/Futility/LMP): "
+              << cumulativeStats.rfpPrunes << " / " << cumulativeStats.razorPrunes << " / "
+              << cumulativeStats.futilityPrunes << " / " << cumulativeStats.lmpPrunes << "\n";
+    std::cout << "Extended (Check/Singular/Recapture): "
+              << cumulativeStats.checkExtensions << " / " << cumulativeStats.singularExtensions << " / "
+              << cumulativeStats.recaptureExtensions << "\n";
+
+    // Fixed format: regression scripts find this line by its prefix and
+    // compare it byte-for-byte. "--- Benchmark Complete ---" still follows it.
+    // Only a deterministic fixed-depth run searches a reproducible tree.
+    if (config.deterministic && config.searchMode == BenchMode::FIXED_DEPTH) {
+        std::cout << "\nBench signature: " << cumulativeStats.totalNodes << "\n";
+    }
+
     std::cout << std::flush;
 }
@@ -1,5 +1,7 @@
 #include "board.h"
+#include "psqt.h"
 
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <cctype>
@@ -7,6 +9,101 @@
 #include <iostream>
 #include <random>
 
+namespace {
+
+// {rank, file} steps. The first four directions increase the square index,
+// so their nearest blocker is the lowest set bit; the last four decrease it.
+constexpr int RAY_STEPS[8][2] = {
+    {1, 0}, {0, 1}, {1, 1}, {1, -1},        // north, east, north-east, north-west
+    {-1, 0}, {0, -1}, {-1, -1}, {-1, 1},    // south, west, south-west, south-east
+};
+
+// Per-square attack masks used to skip work in isSquareAttacked().
+struct AttackMasks {
+    uint64_t knight[64]{};
+    uint64_t king[64]{};
+    uint64_t pawnAttackers[2][64]{};  // squares a pawn of [colour] attacks [square] from
+    uint64_t diagonals[64]{};
+    uint64_t orthogonals[64]{};
+    // Empty-board rays, [direction][square]; see RAY_STEPS.
+    uint64_t rays[8][64]{};
+
+    AttackMasks() {
+        for (int dir = 0; dir < 8; ++dir) {
+            for (int sq = 0; sq < 64; ++sq) {
+                int rank = sq / 8 + RAY_STEPS[dir][0];
+                int file = sq % 8 + RAY_STEPS[dir][1];
+                for (; rank >= 0 && rank < 8 && file >= 0 && file < 8; rank += RAY_STEPS[dir][0], file += RAY_STEPS[dir][1]) {
+                    rays[dir][sq] |= 1ULL << (rank * 8 + file);
+                }
+            }
+        }
+        for (int sq = 0; sq < 64; ++sq) {
+            const int rank = sq / 8;
+            const int file = sq % 8;
+            for (int r = 0; r < 8; ++r) {
+                for (int f = 0; f < 8; ++f) {
+                    const int dr = std::abs(r - rank);
+                    const int df = std::abs(f - file);
+                    const uint64_t bit = 1ULL << (r * 8 + f);
+                    if (dr == 0 && df == 0) continue;
+                    if ((dr == 1 && df == 2) || (dr == 2 && df == 1)) knight[sq] |= bit;
+                    if (dr <= 1 && df <= 1) king[sq] |= bit;
+                    if (dr == df) diagonals[sq] |= bit;
+                    if (dr == 0 || df == 0) orthogonals[sq] |= bit;
+                    if (df == 1 && r == rank - 1) pawnAttackers[static_cast<int>(Color::WHITE)][sq] |= bit;
+                    if (df == 1 && r == rank + 1) pawnAttackers[static_cast<int>(Color::BLACK)][sq] |= bit;
+                }
+            }
+        }
+    }
+};
+
+const AttackMasks ATTACK_MASKS;
+
+uint64_t rayAttacks(int dir, int square, uint64_t occupied) {
+    uint64_t ray = ATTACK_MASKS.rays[dir][square];
+    const uint64_t blockers = ray & occupied;
+    if (blockers) {
+        const int nearest = dir < 4 ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+        ray ^= ATTACK_MASKS.rays[dir][nearest];
+    }
+    return ray;
+}
+
+uint64_t rookAttacks(int square, uint64_t occupied) {
+    return rayAttacks(0, square, occupied) | rayAttacks(1, square, occupied)
+         | rayAttacks(4, square, occupied) | rayAttacks(5, square, occupied);
+}
+
+uint64_t bishopAttacks(int square, uint64_t occupied) {
+    return rayAttacks(2, square, occupied) | rayAttacks(3, square, occupied)
+         | rayAttacks(6, square, occupied) | rayAttacks(7, square, occupied);
+}
+
+} // namespace
+
+uint64_t Board::attacksFrom(PieceIndex piece, int square, uint64_t occupied, Color colour) {
+    switch (piece) {
+    case PAWN: return pawnAttacks(colour, 1ULL << square);
+    case KNIGHT: return ATTACK_MASKS.knight[square];
+    case BISHOP: return bishopAttacks(square, occupied);
+    case ROOK: return rookAttacks(square, occupied);
+    case QUEEN: return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+    case KING: return ATTACK_MASKS.king[square];
+    default: return 0;
+    }
+}
+
+uint64_t Board::pawnAttacks(Color colour, uint64_t pawns) {
+    constexpr uint64_t NOT_A_FILE = 0xFEFEFEFEFEFEFEFEULL;
+    constexpr uint64_t NOT_H_FILE = 0x7F7F7F7F7F7F7F7FULL;
+    if (colour == Color::WHITE) {
+        return ((pawns << 7) & NOT_H_FILE) | ((pawns << 9) & NOT_A_FILE);
+    }
+    return ((pawns >> 9) & NOT_H_FILE) | ((pawns >> 7) & NOT_A_FILE);
+}
+
 uint64_t Board::piece_keys[12][64];
 uint64_t Board::en_passant_keys[64];
 uint64_t Board::castling_keys[16];
@@ -62,8 +159,12 @@ Board::Board() {
     fullmove_number = 1;
 
     move_history.clear();
+    key_history.clear();
 
     current_zobrist_key = calculateZobristKey(*this);
+    psqt_score = calculatePsqtScore(*this);
+    phase_material = calculatePhaseMaterial(*this);
+    accumulators.clear();
 
     // std::cout << "[DEBUG] Initial Zobrist Key: " << current_zobrist_key << std::endl;
 }
@@ -101,6 +202,87 @@ uint64_t Board::calculateZobristKey(const Board& board) {
     return key;
 }
 
+Psqt::Score Board::calculatePsqtScore(const Board& board) {
+    Psqt::Score score = 0;
+    for (int p = 0; p < PieceTypeCount; ++p) {
+        for (uint64_t bb = board.white_bitboards[p]; bb; bb &= bb - 1) {
+            score += Psqt::value(0, p, __builtin_ctzll(bb));
+        }
+        for (uint64_t bb = board.black_bitboards[p]; bb; bb &= bb - 1) {
+            score += Psqt::value(1, p, __builtin_ctzll(bb));
+        }
+    }
+    return score;
+}
+
+int Board::calculatePhaseMaterial(const Board& board) {
+    int phase = 0;
+    for (int p = 0; p < PieceTypeCount; ++p) {
+        const int count = __builtin_popcountll(board.white_bitboards[p]) + __builtin_popcountll(board.black_bitboards[p]);
+        phase += Psqt::PHASE_WEIGHT[p] * count;
+    }
+    return phase;
+}
+
+const Nnue::Accumulator& Board::accumulator() const {
+    const size_t ply = move_history.size();
+    if (accumulators.size() <= ply) accumulators.resize(ply + 1);
+    Nnue::Accumulator& acc = accumulators[ply];
+    if (acc.generation != Nnue::generation()) refreshAccumulator(acc);
+    return acc;
+}
+
+void Board::refreshAccumulator(Nnue::Accumulator& acc) const {
+    Nnue::reset(acc);
+    for (int p = 0; p < PieceTypeCount; ++p) {
+        for (uint64_t bb = white_bitboards[p]; bb; bb &= bb - 1) {
+            Nnue::addPiece(acc, 0, p, __builtin_ctzll(bb));
+        }
+        for (uint64_t bb = black_bitboards[p]; bb; bb &= bb - 1) {
+            Nnue::addPiece(acc, 1, p, __builtin_ctzll(bb));
+        }
+    }
+}
+
+// Called once the move is on move_history. If the parent entry is stale the
+// child is left stale too, and accumulator() rebuilds it when asked.
+void Board::updateAccumulator(const Undo& undo) {
+    const size_t ply = move_history.size();
+    if (accumulators.size() <= ply) accumulators.resize(ply + 1);
+    const Nnue::Accumulator& parent = accumulators[ply - 1];
+    Nnue::Accumulator& child = accumulators[ply];
+    if (parent.generation != Nnue::generation()) {
+        child.generation = 0;
+        return;
+    }
+
+    const Move& move = undo.move;
+    const int them = static_cast<int>(side_to_move);
+    const int us = them ^ 1;
+
+    Nnue::DirtyPieces dirty;
+    dirty.remove(us, undo.moved_piece, move.start);
+    if (move.type == MoveType::PROMOTION) {
+        PieceIndex promoPiece = QUEEN;
+        if (move.promo == 'R') promoPiece = ROOK;
+        else if (move.promo == 'B') promoPiece = BISHOP;
+        else if (move.promo == 'N') promoPiece = KNIGHT;
+        dirty.add(us, promoPiece, move.end);
+    } else {
+        dirty.add(us, undo.moved_piece, move.end);
+    }
+    if (undo.captured_piece != PieceTypeCount) {
+        int capture_square = move.end;
+        if (move.type == MoveType::EN_PASSANT) capture_square = (us == 0 ? move.end - 8 : move.end + 8);
+        dirty.remove(them, undo.captured_piece, capture_square);
+    }
+    if (undo.is_castling_move) {
+        dirty.remove(us, ROOK, undo.castling_rook_from_square);
+        dirty.add(us, ROOK, undo.castling_rook_to_square);
+    }
+    Nnue::update(parent, child, dirty);
+}
+
 void Board::loadFEN(const std::string& fenString) {
     white_bitboards.fill(0);
     black_bitboards.fill(0);
@@ -177,8 +359,12 @@ void Board::loadFEN(const std::string& fenString) {
     }
 
     move_history.clear();
+    key_history.clear();
 
     current_zobrist_key = calculateZobristKey(*this);
+    psqt_score = calculatePsqtScore(*this);
+    phase_material = calculatePhaseMaterial(*this);
+    accumulators.clear();
 }
 
 std::string Board::toFEN() const {
@@ -256,6 +442,11 @@ uint64_t Board::occupancy(Color color) const {
     return occupancy_bitboard;
 }
 
+bool Board::hasNonPawnMaterial(Color color) const {
+    const auto& bitboards = (color == Color::WHITE ? white_bitboards : black_bitboards);
+    return (bitboards[KNIGHT] | bitboards[BISHOP] | bitboards[ROOK] | bitboards[QUEEN]) != 0;
+}
+
 uint64_t Board::pieceBB(Color color, PieceIndex pieceIndex) const {
     return (color == Color::WHITE ? white_bitboards[pieceIndex] : black_bitboards[pieceIndex]);
 }
@@ -454,107 +645,21 @@ int Board::findKing(Color color) const {
 }
 
 bool Board::isSquareAttacked(int squareIndex, Color attackingColor) const {
-    uint64_t white_occupancy = occupancy(Color::WHITE);
-    uint64_t black_occupancy = occupancy(Color::BLACK);
-    uint64_t all_occupancy = white_occupancy | black_occupancy;
-
-    if (attackingColor == Color::WHITE) {
-        for (int pawn_offset : {-7, -9}) {
-            int pawn_square_index = squareIndex + pawn_offset;
-            if (!inBounds(pawn_square_index)) continue;
-            int file_difference = std::abs((pawn_square_index % 8) - (squareIndex % 8));
-            if (file_difference != 1) continue;
-            if (white_bitboards[PAWN] & (1ULL << pawn_square_index)) return true;
-        }
-    }
-    else {
-        for (int pawn_offset : {7, 9}) {
-            int pawn_square_index = squareIndex + pawn_offset;
-            if (!inBounds(pawn_square_index)) continue;
-            int file_difference = std::abs((pawn_square_index % 8) - (squareIndex % 8));
-            if (file_difference != 1) continue;
-            if (black_bitboards[PAWN] & (1ULL << pawn_square_index)) return true;
-        }
-    }
-
-    static const int knight_directions[8] = {-17, -15, -10, -6, 6, 10, 15, 17};
-    uint64_t knight_bitboard = (attackingColor == Color::WHITE ? white_bitboards[KNIGHT] : black_bitboards[KNIGHT]);
-
-    for (int direction : knight_directions) {
-        int knight_square_index = squareIndex + direction;
-        if (!inBounds(knight_square_index)) continue;
-        int file_difference = std::abs((knight_square_index % 8) - (squareIndex % 8));
-        if (file_difference > 2) continue;
-        if (knight_bitboard & (1ULL << knight_square_index)) return true;
-    }
-
-    static const int bishop_directions[4] = {-9, -7, 7, 9};
-    uint64_t bishop_like_bitboard =
-    (attackingColor == Color::WHITE
-         ? white_bitboards[BISHOP] | white_bitboards[QUEEN]
-         : black_bitboards[BISHOP] | black_bitboards[QUEEN]);
-
-    for (int direction : bishop_directions) {
-        int current_square_index = squareIndex;
-        while (true) {
-            int from_file = current_square_index % 8;
-            current_square_index += direction;
-            if (!inBounds(current_square_index)) break;
-            int to_file = current_square_index % 8;
-            if (std::abs(to_file - from_file) != 1) break;
-
-            uint64_t mask = 1ULL << current_square_index;
-            if (all_occupancy & mask) {
-                if (bishop_like_bitboard & mask) return true;
-                break;
-            }
-        }
-    }
+    const auto& attacker = (attackingColor == Color::WHITE ? white_bitboards : black_bitboards);
 
-    static const int rook_directions[4] = {-8, -1, 1, 8};
-    uint64_t rook_like_bitboard =
-    (attackingColor == Color::WHITE
-         ? white_bitboards[ROOK] | white_bitboards[QUEEN]
-         : black_bitboards[ROOK] | black_bitboards[QUEEN]);
+    if (ATTACK_MASKS.pawnAttackers[static_cast<int>(attackingColor)][squareIndex] & attacker[PAWN]) return true;
+    if (ATTACK_MASKS.knight[squareIndex] & attacker[KNIGHT]) return true;
+    if (ATTACK_MASKS.king[squareIndex] & attacker[KING]) return true;
 
-    for (int direction : rook_directions) {
-        int current_square_index = squareIndex;
-        while (true) {
-            int from_rank = current_square_index / 8;
-            int from_file = current_square_index % 8;
-
-            current_square_index += direction;
-            if (!inBounds(current_square_index)) break;
-
-            int to_rank = current_square_index / 8;
-            int to_file = current_square_index % 8;
-
-            if (direction == -1 || direction == 1) {
-                if (to_rank != from_rank) break;
-            }
-
-            uint64_t mask = 1ULL << current_square_index;
-            if (all_occupancy & mask) {
-                if (rook_like_bitboard & mask) return true;
-                break;
-            }
-        }
-    }
-
-    static const int king_directions[8] = {-9, -8, -7, -1, 1, 7, 8, 9};
-    uint64_t king_bitboard =(attackingColor == Color::WHITE ? white_bitboards[KING] : black_bitboards[KING]);
-
-    for (int direction : king_directions) {
-        int king_square_index = squareIndex + direction;
-        if (!inBounds(king_square_index)) continue;
-
-        int file_difference = std::abs((king_square_index % 8) - (squareIndex % 8));
-        int rank_difference = std::abs((king_square_index / 8) - (squareIndex / 8));
-        if (file_difference > 1 || rank_difference > 1) continue;
-
-        if (king_bitboard & (1ULL << king_square_index)) return true;
-    }
+    const uint64_t bishop_like_bitboard = attacker[BISHOP] | attacker[QUEEN];
+    const uint64_t rook_like_bitboard = attacker[ROOK] | attacker[QUEEN];
+    const bool diagonal_possible = (ATTACK_MASKS.diagonals[squareIndex] & bishop_like_bitboard) != 0;
+    const bool orthogonal_possible = (ATTACK_MASKS.orthogonals[squareIndex] & rook_like_bitboard) != 0;
+    if (!diagonal_possible && !orthogonal_possible) return false;
 
+    const uint64_t all_occupancy = occupancy(Color::WHITE) | occupancy(Color::BLACK);
+    if (diagonal_possible && (bishopAttacks(squareIndex, all_occupancy) & bishop_like_bitboard)) return true;
+    if (orthogonal_possible && (rookAttacks(squareIndex, all_occupancy) & rook_like_bitboard)) return true;
     return false;
 }
 
@@ -570,6 +675,10 @@ std::vector<Move> Board::generateLegalMoves() const {
     Color opponent_color = (side_to_move == Color::WHITE ? Color::BLACK : Color::WHITE);
     uint64_t opponent_king_bitboard = pieceBB(opponent_color, KING);
 
+    // One scratch copy for every trial move: a Board carries its history and
+    // accumulator stacks, so copying per move is not cheap.
+    Board scratch = *this;
+
     for (const auto& move : pseudo_moves) {
         if (opponent_king_bitboard & (1ULL << move.end))
             continue;
@@ -583,9 +692,10 @@ std::vector<Move> Board::generateLegalMoves() const {
             if (isSquareAttacked(king_middle_square, opponent_color)) continue;
         }
 
-        Board board_copy = *this;
-        if (board_copy.makeMove(move))
+        if (scratch.makeMove(move)) {
             legal_moves.push_back(move);
+            scratch.unmakeMove();
+        }
     }
 
     return legal_moves;
@@ -600,6 +710,8 @@ bool Board::makeMove(const Move& move) {
     undo_entry.move = move;
 
     undo_entry.zobrist_key = current_zobrist_key;
+    undo_entry.psqt_score = psqt_score;
+    undo_entry.phase_material = phase_material;
 
     undo_entry.is_pawn_double_push = false;
     undo_entry.is_castling_move = false;
@@ -770,7 +882,11 @@ bool Board::makeMove(const Move& move) {
 
     int moved_side_offset = (us_color == Color::WHITE ? 0 : 6);
 
+    const int us = static_cast<int>(us_color);
+    const int them = static_cast<int>(opponent_color);
+
     current_zobrist_key ^= piece_keys[undo_entry.moved_piece + moved_side_offset][move.start];
+    psqt_score -= Psqt::value(us, undo_entry.moved_piece, move.start);
 
     if (move.type == MoveType::PROMOTION) {
         PieceIndex promoPiece = QUEEN;
@@ -778,8 +894,11 @@ bool Board::makeMove(const Move& move) {
         else if (move.promo == 'B') promoPiece = BISHOP;
         else if (move.promo == 'N') promoPiece = KNIGHT;
         current_zobrist_key ^= piece_keys[promoPiece + moved_side_offset][move.end];
+        psqt_score += Psqt::value(us, promoPiece, move.end);
+        phase_material += Psqt::PHASE_WEIGHT[promoPiece];
     } else {
         current_zobrist_key ^= piece_keys[undo_entry.moved_piece + moved_side_offset][move.end];
+        psqt_score += Psqt::value(us, undo_entry.moved_piece, move.end);
     }
 
     if (undo_entry.captured_piece != PieceTypeCount) {
@@ -791,15 +910,20 @@ bool Board::makeMove(const Move& move) {
         }
 
         current_zobrist_key ^= piece_keys[undo_entry.captured_piece + captured_side_offset][capture_square];
+        psqt_score -= Psqt::value(them, undo_entry.captured_piece, capture_square);
+        phase_material -= Psqt::PHASE_WEIGHT[undo_entry.captured_piece];
     }
 
     if (undo_entry.is_castling_move) {
         int rook_side_offset = (us_color == Color::WHITE ? 0 : 6);
         current_zobrist_key ^= piece_keys[ROOK + rook_side_offset][undo_entry.castling_rook_from_square];
         current_zobrist_key ^= piece_keys[ROOK + rook_side_offset][undo_entry.castling_rook_to_square];
+        psqt_score += Psqt::value(us, ROOK, undo_entry.castling_rook_to_square)
+                    - Psqt::value(us, ROOK, undo_entry.castling_rook_from_square);
     }
 
     move_history.push_back(undo_entry);
+    key_history.push_back(undo_entry.zobrist_key);
     // std::cout << "[makeMove] Switched side_to_move to " << (side_to_move == Color::WHITE ? "white" : "black") << " move_history size=" << move_history.size() << "\n";
     // std::cout.flush();
 
@@ -811,6 +935,8 @@ bool Board::makeMove(const Move& move) {
         return false;
     }
 
+    if (Nnue::isLoaded()) updateAccumulator(undo_entry);
+
     // std::cout << "[makeMove] EXIT OK\n";
     // std::cout.flush();
     return true;
@@ -820,8 +946,11 @@ void Board::unmakeMove() {
     assert(!move_history.empty());
     Undo undo_entry = move_history.back();
     move_history.pop_back();
+    key_history.pop_back();
 
     current_zobrist_key = undo_entry.zobrist_key;
+    psqt_score = undo_entry.psqt_score;
+    phase_material = undo_entry.phase_material;
 
     Move move = undo_entry.move;
 
@@ -908,31 +1037,59 @@ bool Board::isStalemate(Color color) const {
 }
 
 bool Board::isFiftyMoveDraw() const {
-    // TODO: implement
-    return false;
+    return halfmove_clock >= 100;
+}
+
+int Board::countRepetitions(int maxCount) const {
+    // Positions with the same side to move sit 2 plies apart, and the first
+    // one that can match is 4 plies back. Nothing before the last capture or
+    // pawn move (halfmove_clock plies) can repeat.
+    const int size = static_cast<int>(key_history.size());
+    const int oldest = std::max(0, size - halfmove_clock);
+    int count = 0;
+
+    for (int i = size - 4; i >= oldest; i -= 2) {
+        if (key_history[i] == current_zobrist_key && ++count >= maxCount) break;
+    }
+    return count;
 }
 
 bool Board::isThreefoldRepetition() const {
-    int repetitionCount = 1;
-    int historySize = move_history.size();
+    return countRepetitions(2) >= 2;
+}
 
-    for (int i = historySize - 2; i >= 0; i -= 2) {
-        if (move_history[i].zobrist_key == current_zobrist_key) {
-            repetitionCount++;
-            if (repetitionCount >= 3) return true;
-        }
+bool Board::isRepetition(int searchPly) const {
+    const int size = static_cast<int>(key_history.size());
+    const int oldest = std::max(0, size - halfmove_clock);
+    const int root = size - searchPly;
+    bool seenBeforeRoot = false;
 
-        if (move_history[i].moved_piece == PAWN ||
-            move_history[i].captured_piece != PieceTypeCount) {
-            break;
-            }
+    for (int i = size - 4; i >= oldest; i -= 2) {
+        if (key_history[i] != current_zobrist_key) continue;
+        if (i > root || seenBeforeRoot) return true;
+        seenBeforeRoot = true;
     }
-
     return false;
 }
 
 bool Board::isInsufficientMaterial() const {
-    // TODO: implement
+    const uint64_t heavy_or_pawns =
+        white_bitboards[PAWN] | white_bitboards[ROOK] | white_bitboards[QUEEN] |
+        black_bitboards[PAWN] | black_bitboards[ROOK] | black_bitboards[QUEEN];
+    if (heavy_or_pawns) return false;
+
+    const uint64_t knights = white_bitboards[KNIGHT] | black_bitboards[KNIGHT];
+    const uint64_t bishops = white_bitboards[BISHOP] | black_bitboards[BISHOP];
+    const int minor_count = __builtin_popcountll(knights | bishops);
+
+    // K vs K, K+minor vs K
+    if (minor_count <= 1) return true;
+
+    // Only bishops, all on the same square colour: no mate is possible.
+    constexpr uint64_t dark_squares = 0xAA55AA55AA55AA55ULL;
+    if (!knights) {
+        return (bishops & dark_squares) == 0 || (bishops & ~dark_squares) == 0;
+    }
     return false;
 }
 
@@ -1028,11 +1185,24 @@ void Board::makeNullMove() {
     undo.en_passant_square_index = en_passant_square_index;
     undo.halfmove_clock = halfmove_clock;
     undo.zobrist_key = current_zobrist_key;
+    undo.psqt_score = psqt_score;
+    undo.phase_material = phase_material;
     undo.move = Move();
     undo.captured_piece = PieceTypeCount;
     undo.moved_piece = PieceTypeCount;
 
     move_history.push_back(undo);
+    key_history.push_back(current_zobrist_key);
+
+    if (Nnue::isLoaded()) {
+        // Same pieces, so the parent's entry carries over unchanged.
+        const size_t ply = move_history.size();
+        if (accumulators.size() <= ply) accumulators.resize(ply + 1);
+        accumulators[ply] = accumulators[ply - 1];
+    }
+
+    // No repetition can span a null move.
+    halfmove_clock = 0;
 
     current_zobrist_key ^= side_key;
     if (en_passant_square_index != -1) {
@@ -1051,4 +1221,5 @@ void Board::unmakeNullMove() {
     halfmove_clock = undo.halfmove_clock;
     side_to_move = (side_to_move == Color::WHITE) ? Color::BLACK : Color::WHITE;
     move_history.pop_back();
+    key_history.pop_back();
 }
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include "endgame.h"
+#include "psqt.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Endgame::KNOWN_WIN;
+
+constexpr uint64_t DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+
+int fileOf(int sq) { return sq & 7; }
+int rankOf(int sq) { return sq >> 3; }
+int distance(int a, int b) {
+    return std::max(std::abs(fileOf(a) - fileOf(b)), std::abs(rankOf(a) - rankOf(b)));
+}
+int edgeDistance(int coordinate) { return std::min(coordinate, 7 - coordinate); }
+
+uint64_t bit(int sq) { return 1ULL << sq; }
+int squareOf(uint64_t bb) { return __builtin_ctzll(bb); }
+uint64_t kingAttacks(int sq) { return Board::attacksFrom(Board::KING, sq, 0); }
+
+Color opponent(Color c) { return c == Color::WHITE ? Color::BLACK : Color::WHITE; }
+
+// Square as seen by the given side: black's pieces are flipped so the
+// evaluators below can treat the strong side as white.
+int relative(Color c, int sq) { return c == Color::WHITE ? sq : sq ^ 56; }
+
+int materialOf(const Board& board, Color c) {
+    int material = 0;
+    for (int piece = Board::PAWN; piece <= Board::QUEEN; ++piece) {
+        const int count = __builtin_popcountll(board.pieceBB(c, static_cast<Board::PieceIndex>(piece)));
+        material += count * Psqt::tables.pieceValue[Psqt::EG][piece];
+    }
+    return material;
+}
+
+// Mop-up shaping: 90 in a corner, 28 in the centre; 120 for adjacent kings,
+// falling 20 per step apart.
+int pushToEdge(int sq) {
+    const int fd = edgeDistance(fileOf(sq));
+    const int rd = edgeDistance(rankOf(sq));
+    return 90 - (7 * fd * fd / 2 + 7 * rd * rd / 2);
+}
+int pushClose(int a, int b) { return 140 - 20 * distance(a, b); }
+int pushAway(int a, int b) { return 120 - pushClose(a, b); }
+// 7 on a1 and h8, 0 on the long light diagonal.
+int pushToDarkCorner(int sq) { return std::abs(7 - rankOf(sq) - fileOf(sq)); }
+// Per square cut off from the lone king (see confinement()).
+constexpr int BOX_WEIGHT = 8;
+
+// ---------------------------------------------------------------------------
+// KPK bitbase, by retrograde analysis over every placement with the strong
+// side as white and the pawn on files a-d.
+// ---------------------------------------------------------------------------
+
+constexpr int KPK_SIZE = 2 * 24 * 64 * 64;   // side to move, pawn, both kings
+
+enum : uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+int kpkIndex(int whiteToMove, int blackKing, int whiteKing, int pawn) {
+    return whiteKing | (blackKing << 6) | ((whiteToMove ^ 1) << 12)
+         | (fileOf(pawn) << 13) | ((6 - rankOf(pawn)) << 15);
+}
+
+struct KpkPosition {
+    int whiteKing, blackKing, pawn;
+    bool whiteToMove;
+
+    explicit KpkPosition(int index)
+        : whiteKing(index & 63),
+          blackKing((index >> 6) & 63),
+          pawn(((index >> 13) & 3) | ((6 - (index >> 15)) << 3)),
+          whiteToMove(((index >> 12) & 1) == 0) {}
+
+    uint8_t initial() const {
+        const uint64_t pawnAttacks = Board::pawnAttacks(Color::WHITE, bit(pawn));
+        if (distance(whiteKing, blackKing) <= 1 || whiteKing == pawn || blackKing == pawn
+            || (whiteToMove && (pawnAttacks & bit(blackKing)))) {
+            return INVALID;
+        }
+        // Promotes without the new queen being taken.
+        const int promotion = pawn + 8;
+        if (whiteToMove && rankOf(pawn) == 6 && whiteKing != promotion && blackKing != promotion
+            && (distance(blackKing, promotion) > 1 || distance(whiteKing, promotion) == 1)) {
+            return WIN;
+        }
+        // Stalemated, or takes an undefended pawn.
+        if (!whiteToMove
+            && (!(kingAttacks(blackKing) & ~(kingAttacks(whiteKing) | pawnAttacks))
+                || (kingAttacks(blackKing) & bit(pawn) & ~kingAttacks(whiteKing)))) {
+            return DRAW;
+        }
+        return UNKNOWN;
+    }
+
+    // A side wins (or holds) if any move reaches a position good for it;
+    // moves into illegal placements read as INVALID and count for nothing.
+    uint8_t classify(const std::vector<uint8_t>& db) const {
+        const uint8_t good = whiteToMove ? WIN : DRAW;
+        const uint8_t bad = whiteToMove ? DRAW : WIN;
+
+        uint8_t r = INVALID;
+        uint64_t moves = kingAttacks(whiteToMove ? whiteKing : blackKing);
+        while (moves) {
+            const int to = squareOf(moves);
+            moves &= moves - 1;
+            r |= whiteToMove ? db[kpkIndex(0, blackKing, to, pawn)] : db[kpkIndex(1, to, whiteKing, pawn)];
+        }
+        if (whiteToMove) {
+            if (rankOf(pawn) < 6) r |= db[kpkIndex(0, blackKing, whiteKing, pawn + 8)];
+            if (rankOf(pawn) == 1 && pawn + 8 != whiteKing && pawn + 8 != blackKing) {
+                r |= db[kpkIndex(0, blackKing, whiteKing, pawn + 16)];
+            }
+        }
+        return (r & good) ? good : (r & UNKNOWN) ? static_cast<uint8_t>(UNKNOWN) : bad;
+    }
+};
+
+std::vector<uint64_t> buildKpk() {
+    std::vector<uint8_t> db(KPK_SIZE);
+    for (int i = 0; i < KPK_SIZE; ++i) db[i] = KpkPosition(i).initial();
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < KPK_SIZE; ++i) {
+            if (db[i] == UNKNOWN && (db[i] = KpkPosition(i).classify(db)) != UNKNOWN) changed = true;
+        }
+    }
+
+    // Whatever is still unknown cannot be forced, so it is a draw.
+    std::vector<uint64_t> wins(KPK_SIZE / 64);
+    for (int i = 0; i < KPK_SIZE; ++i) {
+        if (db[i] == WIN) wins[i / 64] |= 1ULL << (i % 64);
+    }
+    return wins;
+}
+
+const std::vector<uint64_t>& kpkTable() {
+    static const std::vector<uint64_t> wins = buildKpk();
+    return wins;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluators. Each scores from the strong side's point of view.
+// ---------------------------------------------------------------------------
+
+using EvalFn = int (*)(const Board& board, Color strong);
+
+struct Kings {
+    int strong, weak;
+    Kings(const Board& board, Color side)
+        : strong(relative(side, squareOf(board.pieceBB(side, Board::KING)))),
+          weak(relative(side, squareOf(board.pieceBB(opponent(side), Board::KING)))) {}
+};
+
+// Squares the strong side attacks, seeing through the weak king so a
+// slider's line does not stop at it.
+uint64_t attackedBy(const Board& board, Color strong) {
+    const uint64_t occupied = (board.occupancy(Color::WHITE) | board.occupancy(Color::BLACK))
+                            & ~board.pieceBB(opponent(strong), Board::KING);
+    uint64_t attacked = Board::pawnAttacks(strong, board.pieceBB(strong, Board::PAWN));
+    for (int piece = Board::KNIGHT; piece <= Board::KING; ++piece) {
+        uint64_t pieces = board.pieceBB(strong, static_cast<Board::PieceIndex>(piece));
+        while (pieces) {
+            attacked |= Board::attacksFrom(static_cast<Board::PieceIndex>(piece), squareOf(pieces), occupied, strong);
+            pieces &= pieces - 1;
+        }
+    }
+    return attacked;
+}
+
+// Bonus for the squares the lone king could not walk to if nothing else
+// moved, i.e. for shrinking its box.
+int confinement(const Board& board, Color strong) {
+    const uint64_t king = board.pieceBB(opponent(strong), Board::KING);
+    const uint64_t open = ~attackedBy(board, strong) | king;
+    uint64_t box = king;
+    for (;;) {
+        uint64_t grown = box;
+        for (uint64_t frontier = box; frontier; frontier &= frontier - 1) {
+            grown |= kingAttacks(squareOf(frontier));
+        }
+        grown &= open;
+        if (grown == box) return BOX_WEIGHT * (64 - __builtin_popcountll(box));
+        box = grown;
+    }
+}
+
+// Lone king against mating material: shrink its box, drive it to the edge
+// and close in.
+int evaluateKXK(const Board& board, Color strong) {
+    const Kings k(board, strong);
+    return KNOWN_WIN + materialOf(board, strong) + confinement(board, strong)
+         + pushToEdge(k.weak) + pushClose(k.strong, k.weak);
+}
+
+// Mate is only possible in a corner the bishop covers.
+int evaluateKBNK(const Board& board, Color strong) {
+    const Kings k(board, strong);
+    const int bishop = relative(strong, squareOf(board.pieceBB(strong, Board::BISHOP)));
+    const int corner = (bit(bishop) & DARK_SQUARES) ? k.weak : k.weak ^ 7;
+    return KNOWN_WIN + materialOf(board, strong) + confinement(board, strong)
+         + pushClose(k.strong, k.weak) + 420 * pushToDarkCorner(corner);
+}
+
+int evaluateKPK(const Board& board, Color strong) {
+    const Kings k(board, strong);
+    const int pawn = relative(strong, squareOf(board.pieceBB(strong, Board::PAWN)));
+    if (!Endgame::kpkWin(k.strong, pawn, k.weak, board.sideToMove() == strong)) return 0;
+    return KNOWN_WIN + Psqt::tables.pieceValue[Psqt::EG][Board::PAWN] + rankOf(pawn);
+}
+
+// Rook against pawn: a win unless the defending king escorts an advanced
+// pawn while the attacking king is far away.
+int evaluateKRKP(const Board& board, Color strong) {
+    const Kings k(board, strong);
+    const int rook = relative(strong, squareOf(board.pieceBB(strong, Board::ROOK)));
+    const int pawn = relative(strong, squareOf(board.pieceBB(opponent(strong), Board::PAWN)));
+    const int queening = fileOf(pawn);
+    const bool weakToMove = board.sideToMove() != strong;
+    const int rookValue = Psqt::tables.pieceValue[Psqt::EG][Board::ROOK];
+
+    // The strong king stands in front of the pawn.
+    if (fileOf(k.strong) == fileOf(pawn) && rankOf(k.strong) < rankOf(pawn)) {
+        return rookValue - distance(k.strong, pawn);
+    }
+    // The weak king is too far from both pawn and rook.
+    if (distance(k.weak, pawn) >= 3 + weakToMove && distance(k.weak, rook) >= 3) {
+        return rookValue - distance(k.strong, pawn);
+    }
+    // Advanced pawn supported by its king: drawish.
+    if (rankOf(k.weak) <= 2 && distance(k.weak, pawn) == 1 && rankOf(k.strong) >= 3
+        && distance(k.strong, pawn) > 2 + !weakToMove) {
+        return 80 - 8 * distance(k.strong, pawn);
+    }
+    return 200 - 8 * (distance(k.strong, pawn - 8) - distance(k.weak, pawn - 8) - distance(pawn, queening));
+}
+
+// Usually drawn; the edge is where the rook side has chances.
+int evaluateKRKB(const Board& board, Color strong) {
+    return pushToEdge(Kings(board, strong).weak);
+}
+
+int evaluateKRKN(const Board& board, Color strong) {
+    const Kings k(board, strong);
+    const int knight = relative(strong, squareOf(board.pieceBB(opponent(strong), Board::KNIGHT)));
+    return pushToEdge(k.weak) + pushAway(k.weak, knight);
+}
+
+int evaluateDraw(const Board&, Color) { return 0; }
+
+// ---------------------------------------------------------------------------
+// Registry by material signature: four bits per piece count, pawn to queen,
+// white's in the low 20 bits.
+// ---------------------------------------------------------------------------
+
+constexpr int countShift(int colour, int piece) { return colour * 20 + piece * 4; }
+
+constexpr int pieceOf(char c) {
+    return c == 'P' ? Board::PAWN : c == 'N' ? Board::KNIGHT : c == 'B' ? Board::BISHOP
+         : c == 'R' ? Board::ROOK : Board::QUEEN;
+}
+
+// "KRKP": the strong side's pieces, then the weak side's, each led by its king.
+constexpr uint64_t signature(const char* code, int strongColour) {
+    uint64_t key = 0;
+    int side = -1;
+    for (const char* c = code; *c; ++c) {
+        if (*c == 'K') {
+            ++side;
+            continue;
+        }
+        const int colour = side == 0 ? strongColour : strongColour ^ 1;
+        key += 1ULL << countShift(colour, pieceOf(*c));
+    }
+    return key;
+}
+
+uint64_t materialKey(const Board& board) {
+    uint64_t key = 0;
+    for (int colour = 0; colour < 2; ++colour) {
+        for (int piece = Board::PAWN; piece <= Board::QUEEN; ++piece) {
+            const uint64_t pieces = board.pieceBB(static_cast<Color>(colour), static_cast<Board::PieceIndex>(piece));
+            key += static_cast<uint64_t>(__builtin_popcountll(pieces)) << countShift(colour, piece);
+        }
+    }
+    return key;
+}
+
+struct Specialized {
+    const char* code;
+    EvalFn evaluate;
+};
+
+constexpr Specialized SPECIALIZED[] = {
+    {"KPK", evaluateKPK},
+    {"KBNK", evaluateKBNK},
+    {"KRKP", evaluateKRKP},
+    {"KRKB", evaluateKRKB},
+    {"KRKN", evaluateKRKN},
+    {"KNNK", evaluateDraw},
+};
+constexpr int SPECIALIZED_COUNT = sizeof(SPECIALIZED) / sizeof(SPECIALIZED[0]);
+
+// Largest signature in SPECIALIZED; anything with more pieces skips the lookup.
+constexpr int MAX_SPECIALIZED_PIECES = 5;
+
+struct Entry {
+    uint64_t key;
+    EvalFn evaluate;
+    Color strong;
+};
+
+constexpr std::array<Entry, 2 * SPECIALIZED_COUNT> makeRegistry() {
+    std::array<Entry, 2 * SPECIALIZED_COUNT> entries{};
+    for (int i = 0; i < SPECIALIZED_COUNT; ++i) {
+        entries[2 * i] = {signature(SPECIALIZED[i].code, 0), SPECIALIZED[i].evaluate, Color::WHITE};
+        entries[2 * i + 1] = {signature(SPECIALIZED[i].code, 1), SPECIALIZED[i].evaluate, Color::BLACK};
+    }
+    return entries;
+}
+
+constexpr std::array<Entry, 2 * SPECIALIZED_COUNT> REGISTRY = makeRegistry();
+
+static_assert(signature("KRKP", 0) == ((1ULL << countShift(0, Board::ROOK)) | (1ULL << countShift(1, Board::PAWN))),
+              "signatures must be built at compile time");
+
+// Queen, rook, bishops on both colours, or bishop and knight: enough to mate
+// a bare king without help from pawns.
+bool hasMatingMaterial(const Board& board, Color c) {
+    if (board.pieceBB(c, Board::QUEEN) || board.pieceBB(c, Board::ROOK)) return true;
+    const uint64_t bishops = board.pieceBB(c, Board::BISHOP);
+    if ((bishops & DARK_SQUARES) && (bishops & ~DARK_SQUARES)) return true;
+    return bishops && board.pieceBB(c, Board::KNIGHT);
+}
+
+} // namespace
+
+namespace Endgame {
+
+void init() {
+    kpkTable();
+}
+
+bool kpkWin(int strongKing, int pawn, int weakKing, bool strongToMove) {
+    const std::vector<uint64_t>& wins = kpkTable();
+    if (fileOf(pawn) > 3) {
+        strongKing ^= 7;
+        pawn ^= 7;
+        weakKing ^= 7;
+    }
+    const int index = kpkIndex(strongToMove, weakKing, strongKing, pawn);
+    return (wins[index / 64] >> (index % 64)) & 1;
+}
+
+bool probe(const Board& board, int& score) {
+    const uint64_t white = board.occupancy(Color::WHITE);
+    const uint64_t black = board.occupancy(Color::BLACK);
+    const uint64_t whiteKing = board.pieceBB(Color::WHITE, Board::KING);
+    const uint64_t blackKing = board.pieceBB(Color::BLACK, Board::KING);
+    const bool whiteBare = white == whiteKing;
+    const bool blackBare = black == blackKing;
+    const int pieces = __builtin_popcountll(white | black);
+    if (pieces > MAX_SPECIALIZED_PIECES && !whiteBare && !blackBare) return false;
+    if (!whiteKing || !blackKing) return false;
+
+    if (board.isInsufficientMaterial()) {
+        score = 0;
+        return true;
+    }
+
+    const Color us = board.sideToMove();
+    if (pieces <= MAX_SPECIALIZED_PIECES) {
+        const uint64_t key = materialKey(board);
+        for (const Entry& e : REGISTRY) {
+            if (e.key == key) {
+                const int s = e.evaluate(board, e.strong);
+                score = us == e.strong ? s : -s;
+                return true;
+            }
+        }
+    }
+
+    if (whiteBare != blackBare) {
+        const Color strong = whiteBare ? Color::BLACK : Color::WHITE;
+        if (hasMatingMaterial(board, strong)) {
+            const int s = evaluateKXK(board, strong);
+            score = us == strong ? s : -s;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Endgame
@@ -1,17 +1,27 @@
 #include "main.h"
+#include "endgame.h"
 
 Engine::Engine()
     : tt(64), searcher(evaluator, tt) {
     history.clear();
+    Endgame::init();
 }
 
-Engine::~Engine() = default;
+Engine::~Engine() {
+    stopSearch();
+}
 
 void Engine::reset() {
     board.loadFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
     history.clear();
 }
 
+void Engine::newGame() {
+    reset();
+    tt.clear();
+    searcher.clearHistory();
+}
+
 bool Engine::setPosition(const std::string& fen) {
     try {
         board.loadFEN(fen);
@@ -48,8 +58,44 @@ bool Engine::applyMove(const std::string& moveStr) {
 }
 
 std::string Engine::playMove(const PlaySettings& settings) {
+    searcher.resetSignals(settings.ponder);
+    return runSearch(settings, false);
+}
+
+void Engine::startSearch(const PlaySettings& settings, BestMoveCallback onBestMove) {
+    waitForSearch();
+    // Arm the signals here rather than on the search thread, so a stop or
+    // ponderhit that arrives before the thread gets going is not lost.
+    searcher.resetSignals(settings.ponder);
+    search_thread = std::thread([this, settings, onBestMove] {
+        std::string best = runSearch(settings, true);
+        onBestMove(best, last_ponder_move);
+    });
+}
+
+void Engine::stopSearch() {
+    searcher.stop();
+    waitForSearch();
+}
+
+void Engine::ponderhit() {
+    searcher.ponderhit();
+}
+
+void Engine::waitForSearch() {
+    if (search_thread.joinable()) search_thread.join();
+}
+
+std::string Engine::runSearch(const PlaySettings& settings, bool report) {
+    last_ponder_move.clear();
+    searcher.setInfoCallback(report ? info_callback : nullptr);
+    searcher.setCurrMoveCallback(report ? currmove_callback : nullptr);
+
     // Book probe: handles transposition naturally (hash-keyed), bounded by fullmove cutoff.
-    if (use_book && opening_book.isLoaded() && board.fullmoveNumber() <= book_max_fullmove) {
+    // Analysis and ponder searches must wait for stop/ponderhit, and node or
+    // mate searches are asked for a search result, so they all skip the book.
+    if (use_book && !settings.infinite && !settings.ponder && settings.nodes == 0 && settings.mate == 0
+        && opening_book.isLoaded() && board.fullmoveNumber() <= book_max_fullmove) {
         Move book_move = opening_book.probe(board);
         if (book_move.isValid()) {
             board.makeMove(book_move);
@@ -59,14 +105,20 @@ std::string Engine::playMove(const PlaySettings& settings) {
         }
     }
 
-    Move best = searcher.findBestMove(
-        board,
-        settings.depth,
-        settings.time_left_ms,
-        settings.increment_ms,
-        settings.moves_to_go,
-        settings.movetime_ms
-    );
+    SearchLimits limits;
+    limits.depth = settings.depth;
+    limits.timeLeftMs = settings.time_left_ms;
+    limits.incrementMs = settings.increment_ms;
+    limits.movesToGo = settings.moves_to_go;
+    limits.movetimeMs = settings.movetime_ms;
+    limits.infinite = settings.infinite;
+    limits.nodes = settings.nodes;
+    limits.mate = settings.mate;
+
+    Move best = searcher.findBestMove(board, limits);
+
+    Move ponder = searcher.getPonderMove();
+    if (ponder.isValid()) last_ponder_move = ponder.toString();
 
     board.makeMove(best);
     std::string uci = best.toString();
@@ -74,6 +126,17 @@ std::string Engine::playMove(const PlaySettings& settings) {
     return uci;
 }
 
+bool Engine::loadEvalFile(const std::string& path) {
+    if (!Nnue::load(path)) return false;
+    tt.clear();
+    return true;
+}
+
+void Engine::clearEvalFile() {
+    Nnue::unload();
+    tt.clear();
+}
+
 bool Engine::isGameOver() const {
     return board.isCheckmate(board.sideToMove())
         || board.isStalemate(board.sideToMove())
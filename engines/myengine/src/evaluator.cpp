@@ -1,226 +1,274 @@
 #include "evaluator.h"
+#include "endgame.h"
+#include "nnue.h"
+#include "psqt.h"
 #include <algorithm>
+#include <limits>
+#include <type_traits>
 
 static constexpr int MATE_SCORE = 100000;
 
-Evaluator::Evaluator() {
-    initializePieceSquareTables();
+static_assert(std::is_trivially_copyable<Evaluator>::value && sizeof(Evaluator) <= 8,
+              "Evaluator must stay cheap to copy per thread");
+
+namespace {
+
+using Psqt::Score;
+using Psqt::makeScore;
+
+// Piece activity, as packed midgame/endgame weights in one flat block so the
+// tuner can address every entry. Terms are counted per piece of the side
+// that benefits.
+constexpr int MOBILITY_SLOTS = 28;                    // 0..27 squares, enough for a queen
+constexpr int MOBILITY = 0;                           // [knight..queen][squares reached]
+constexpr int KING_ATTACK = MOBILITY + 4 * MOBILITY_SLOTS;   // [knight..queen]: per attack on the enemy king zone
+constexpr int THREAT_BY_PAWN = KING_ATTACK + 4;       // [victim]: enemy piece attacked by a pawn
+constexpr int THREAT_BY_MINOR = THREAT_BY_PAWN + 6;   // [victim]: ... by a knight or bishop
+constexpr int THREAT_BY_ROOK = THREAT_BY_MINOR + 6;   // [victim]: ... by a rook
+constexpr int HANGING = THREAT_BY_ROOK + 6;           // enemy piece attacked and not defended
+constexpr int ACTIVITY_COUNT = HANGING + 1;
+
+struct ActivityWeights {
+    Score weights[ACTIVITY_COUNT];
+};
+
+constexpr ActivityWeights makeDefaultActivity() {
+    ActivityWeights a{};
+    // Mobility is centred on a typical square count, so an average piece
+    // scores about zero and its material value stays meaningful.
+    constexpr int centre[4] = {4, 6, 7, 13};
+    constexpr int perSquare[4][2] = {{4, 4}, {5, 5}, {2, 4}, {1, 2}};
+    for (int piece = 0; piece < 4; ++piece) {
+        for (int n = 0; n < MOBILITY_SLOTS; ++n) {
+            a.weights[MOBILITY + piece * MOBILITY_SLOTS + n] =
+                makeScore(perSquare[piece][0] * (n - centre[piece]), perSquare[piece][1] * (n - centre[piece]));
+        }
+    }
+    constexpr int kingAttack[4] = {8, 5, 8, 12};
+    for (int piece = 0; piece < 4; ++piece) a.weights[KING_ATTACK + piece] = makeScore(kingAttack[piece], 0);
+
+    //                                  P            N             B             R             Q             K
+    constexpr Score byPawn[6]  = {makeScore(0, 0), makeScore(40, 30), makeScore(40, 30), makeScore(55, 40), makeScore(60, 45), 0};
+    constexpr Score byMinor[6] = {makeScore(3, 8), makeScore(10, 12), makeScore(10, 12), makeScore(30, 35), makeScore(35, 45), 0};
+    constexpr Score byRook[6]  = {makeScore(3, 10), makeScore(10, 15), makeScore(10, 15), makeScore(0, 5), makeScore(40, 40), 0};
+    for (int victim = 0; victim < 6; ++victim) {
+        a.weights[THREAT_BY_PAWN + victim] = byPawn[victim];
+        a.weights[THREAT_BY_MINOR + victim] = byMinor[victim];
+        a.weights[THREAT_BY_ROOK + victim] = byRook[victim];
+    }
+    a.weights[HANGING] = makeScore(30, 20);
+    return a;
 }
 
-int Evaluator::evaluate(const Board& board, Color sideToMove) const {
-    int score = 0;
+// Process-wide like Psqt::tables, and under the same rules: setParameter
+// edits it in place, and only while no search is running.
+ActivityWeights activity = makeDefaultActivity();
 
-    auto evalPieceType = [&](const std::vector<int>& whiteTable, const std::vector<int>& blackTable, Board::PieceIndex pieceTable) {
-        int value = pieceValues[pieceTable];
+// Calls term(index, count) for every activity term in the position, with
+// count signed from white's side. Attack maps are built once per side and
+// shared by the mobility, king-zone and threat terms.
+template <typename Term>
+void visitActivity(const Board& board, Term&& term) {
+    const Color colours[2] = {Color::WHITE, Color::BLACK};
+    const uint64_t occupied = board.occupancy(Color::WHITE) | board.occupancy(Color::BLACK);
 
-        uint64_t whiteBitBoard = board.pieceBB(Color::WHITE, pieceTable);
-        while (whiteBitBoard) {
-            int square = __builtin_ctzll(whiteBitBoard);
-            score += (value + whiteTable[square]);
-            whiteBitBoard &= whiteBitBoard - 1;
+    uint64_t attacks[2][6] = {};
+    uint64_t kingZone[2] = {};
+    for (int c = 0; c < 2; ++c) {
+        attacks[c][Board::PAWN] = Board::pawnAttacks(colours[c], board.pieceBB(colours[c], Board::PAWN));
+        const uint64_t king = board.pieceBB(colours[c], Board::KING);
+        if (king) {
+            attacks[c][Board::KING] = Board::attacksFrom(Board::KING, __builtin_ctzll(king), occupied);
+            kingZone[c] = attacks[c][Board::KING] | king;
         }
+    }
 
-        uint64_t blackBitBoard = board.pieceBB(Color::BLACK, pieceTable);
-        while (blackBitBoard) {
-            int square = __builtin_ctzll(blackBitBoard);
-            score -= (value + blackTable[square]);
-            blackBitBoard &= blackBitBoard - 1;
+    for (int c = 0; c < 2; ++c) {
+        const int sign = c == 0 ? 1 : -1;
+        const int them = c ^ 1;
+        const uint64_t mobilityArea = ~(board.occupancy(colours[c]) | attacks[them][Board::PAWN]);
+        for (int piece = Board::KNIGHT; piece <= Board::QUEEN; ++piece) {
+            const auto type = static_cast<Board::PieceIndex>(piece);
+            for (uint64_t bb = board.pieceBB(colours[c], type); bb; bb &= bb - 1) {
+                const uint64_t att = Board::attacksFrom(type, __builtin_ctzll(bb), occupied);
+                attacks[c][piece] |= att;
+                term(MOBILITY + (piece - Board::KNIGHT) * MOBILITY_SLOTS + __builtin_popcountll(att & mobilityArea), sign);
+                if (const int n = __builtin_popcountll(att & kingZone[them])) {
+                    term(KING_ATTACK + piece - Board::KNIGHT, sign * n);
+                }
+            }
         }
-    };
+    }
 
-    evalPieceType(whitePawnTable, blackPawnTable, Board::PAWN);
-    evalPieceType(whiteKnightTable, blackKnightTable, Board::KNIGHT);
-    evalPieceType(whiteBishopTable, blackBishopTable, Board::BISHOP);
-    evalPieceType(whiteRookTable, blackRookTable, Board::ROOK);
-    evalPieceType(whiteQueenTable, blackQueenTable, Board::QUEEN);
-    evalPieceType(whiteKingTableMG, blackKingTableMG, Board::KING);
+    uint64_t all[2] = {};
+    for (int c = 0; c < 2; ++c) {
+        for (uint64_t a : attacks[c]) all[c] |= a;
+    }
 
-    return (sideToMove == Color::WHITE ? score : -score);
+    for (int c = 0; c < 2; ++c) {
+        const int sign = c == 0 ? 1 : -1;
+        const Color them = colours[c ^ 1];
+        const uint64_t minorAttacks = attacks[c][Board::KNIGHT] | attacks[c][Board::BISHOP];
+        uint64_t targets = 0;
+        for (int victim = Board::PAWN; victim <= Board::QUEEN; ++victim) {
+            const uint64_t pieces = board.pieceBB(them, static_cast<Board::PieceIndex>(victim));
+            if (const int n = __builtin_popcountll(pieces & attacks[c][Board::PAWN])) term(THREAT_BY_PAWN + victim, sign * n);
+            if (const int n = __builtin_popcountll(pieces & minorAttacks)) term(THREAT_BY_MINOR + victim, sign * n);
+            if (const int n = __builtin_popcountll(pieces & attacks[c][Board::ROOK])) term(THREAT_BY_ROOK + victim, sign * n);
+            if (victim != Board::PAWN) targets |= pieces;
+        }
+        if (const int n = __builtin_popcountll(targets & all[c] & ~all[c ^ 1])) term(HANGING, sign * n);
+    }
 }
 
-int Evaluator::evaluateTerminal(const Board& board, const Color side_to_move) {
-    if (board.isCheckmate(side_to_move)) return -MATE_SCORE;
-    return 0;
+Score activityScore(const Board& board) {
+    Score score = 0;
+    visitActivity(board, [&](int index, int count) { score += count * activity.weights[index]; });
+    return score;
 }
 
-int Evaluator::evaluateMaterial(const Board& board) const {
-    auto countSetBits = [](const uint64_t bits) {return __builtin_popcountll(bits);};
+} // namespace
+
+int Evaluator::evaluate(const Board& board, Color sideToMove) const {
+    int endgame;
+    if (specializedEndgames_ && Endgame::probe(board, endgame)) {
+        return (sideToMove == board.sideToMove() ? endgame : -endgame);
+    }
+    if (Nnue::isLoaded()) {
+        const int score = Nnue::evaluate(board.accumulator(), static_cast<int>(board.sideToMove()));
+        return (sideToMove == board.sideToMove() ? score : -score);
+    }
+    const int score = Psqt::taper(board.psqtScore() + activityScore(board), gamePhase(board));
+    return (sideToMove == Color::WHITE ? score : -score);
+}
 
-    int score = 0;
-    for (int pt = 0; pt < PST_COUNT; ++pt) {
-        const int whiteCount = countSetBits(board.pieceBB(Color::WHITE, static_cast<Board::PieceIndex>(pt)));
-        const int blackCount = countSetBits(board.pieceBB(Color::BLACK, static_cast<Board::PieceIndex>(pt)));
+// LAZY_MARGIN is above the largest activity total seen on the tuning data
+// (about 330 cp), so the full score lies within it of the partial one.
+int Evaluator::evaluate(const Board& board, int alpha, int beta, bool* lazy) const {
+    if (lazy) *lazy = false;
+    int endgame;
+    if (specializedEndgames_ && Endgame::probe(board, endgame)) return endgame;
+    if (Nnue::isLoaded()) return evaluate(board, board.sideToMove());
 
-        score += pieceValues[pt] * (whiteCount - blackCount);
+    const int sign = board.sideToMove() == Color::WHITE ? 1 : -1;
+    const int phase = gamePhase(board);
+    const int partial = sign * Psqt::taper(board.psqtScore(), phase);
+    if (partial - LAZY_MARGIN >= beta || partial + LAZY_MARGIN <= alpha) {
+        if (lazy) *lazy = true;
+        return partial >= beta ? partial - LAZY_MARGIN : partial + LAZY_MARGIN;
     }
-    return score;
+    return sign * Psqt::taper(board.psqtScore() + activityScore(board), phase);
 }
 
-int Evaluator::evaluatePositional(const Board& board) const {
-    int score = 0;
+// Boards per block: small enough for the arrays to stay in L1.
+static constexpr std::size_t BATCH_BLOCK = 256;
+
+void Evaluator::evaluateBatch(const Board* boards, std::size_t count, int* scores) const {
+    if (Nnue::isLoaded()) {
+        for (std::size_t i = 0; i < count; ++i) scores[i] = evaluate(boards[i], Color::WHITE);
+        return;
+    }
 
-    auto applyPST = [&](uint64_t bitboard, const std::vector<int>& table, const int sign) {
-        while (bitboard) {
-            int square = __builtin_ctzll(bitboard);
-            score += sign * table[square];
-            bitboard &= bitboard - 1;
+    alignas(64) int32_t packed[BATCH_BLOCK];
+    alignas(64) int32_t phase[BATCH_BLOCK];
+    alignas(64) int32_t mg[BATCH_BLOCK];
+    alignas(64) int32_t eg[BATCH_BLOCK];
+
+    for (std::size_t start = 0; start < count; start += BATCH_BLOCK) {
+        const std::size_t n = std::min(BATCH_BLOCK, count - start);
+        const Board* block = boards + start;
+        int* out = scores + start;
+
+        // Scalar: activityScore builds attack maps one board at a time.
+        for (std::size_t i = 0; i < n; ++i) {
+            packed[i] = block[i].psqtScore() + activityScore(block[i]);
+            phase[i] = std::min(block[i].phaseMaterial(), Psqt::MAX_PHASE);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            mg[i] = Psqt::mgValue(packed[i]);
+            eg[i] = Psqt::egValue(packed[i]);
         }
-    };
-
-    applyPST(board.pieceBB(Color::WHITE, Board::PAWN), whitePawnTable, 1);
-    applyPST(board.pieceBB(Color::WHITE, Board::KNIGHT), whiteKnightTable, 1);
-    applyPST(board.pieceBB(Color::WHITE, Board::BISHOP), whiteBishopTable, 1);
-    applyPST(board.pieceBB(Color::WHITE, Board::ROOK), whiteRookTable, 1);
-    applyPST(board.pieceBB(Color::WHITE, Board::QUEEN), whiteQueenTable, 1);
-    applyPST(board.pieceBB(Color::WHITE, Board::KING), whiteKingTableMG, 1);
-
-    applyPST(board.pieceBB(Color::BLACK, Board::PAWN), blackPawnTable, -1);
-    applyPST(board.pieceBB(Color::BLACK, Board::KNIGHT), blackKnightTable, -1);
-    applyPST(board.pieceBB(Color::BLACK, Board::BISHOP), blackBishopTable, -1);
-    applyPST(board.pieceBB(Color::BLACK, Board::ROOK), blackRookTable, -1);
-    applyPST(board.pieceBB(Color::BLACK, Board::QUEEN), blackQueenTable, -1);
-    applyPST(board.pieceBB(Color::BLACK, Board::KING), blackKingTableMG, -1);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = (mg[i] * phase[i] + eg[i] * (Psqt::MAX_PHASE - phase[i])) / Psqt::MAX_PHASE;
+        }
+        // Scalar too, and rare: most boards have no specialized endgame.
+        for (std::size_t i = 0; i < n; ++i) {
+            int endgame;
+            if (specializedEndgames_ && Endgame::probe(block[i], endgame)) {
+                out[i] = block[i].sideToMove() == Color::WHITE ? endgame : -endgame;
+            }
+        }
+    }
+}
 
-    return score;
+int Evaluator::gamePhase(const Board& board) {
+    return std::min(board.phaseMaterial(), Psqt::MAX_PHASE);
 }
 
-void Evaluator::initializePieceSquareTables() {
-    // -----------------------------------------------------------
-    // 1. AGGRESSIVE PAWN TABLE
-    // Logic: Rank 2 is 0. Rank 4 (center) is highly rewarded.
-    // Rank 7 is massive (promotion threat).
-    // -----------------------------------------------------------
-    whitePawnTable = {
-        0, 0, 0, 0, 0, 0, 0, 0,
-        5, 10, 10, -20, -20, 10, 10, 5,
-        5, -5, 0, 5, 5, 0, -5, 5,
-        0, 0, 10, 40, 40, 10, 0, 0, // Rank 4: +40 for e4/d4 (was 20)
-        5, 5, 20, 60, 60, 20, 5, 5, // Rank 5: +60 for e5/d5
-        10, 10, 30, 80, 80, 30, 10, 10, // Rank 6: Crushing
-        50, 50, 50, 50, 50, 50, 50, 50,
-        0, 0, 0, 0, 0, 0, 0, 0
-    };
-
-    whiteKnightTable = {
-        -50, -40, -30, -30, -30, -30, -40, -50,
-        -40, -20, 0, 0, 0, 0, -20, -40,
-        -30, 0, 10, 15, 15, 10, 0, -30,
-        -30, 5, 15, 20, 20, 15, 5, -30,
-        -30, 0, 15, 20, 20, 15, 0, -30,
-        -30, 5, 10, 15, 15, 10, 5, -30,
-        -40, -20, 0, 5, 5, 0, -20, -40,
-        -50, -40, -30, -30, -30, -30, -40, -50
-    };
-
-    whiteBishopTable = {
-        -20, -10, -10, -10, -10, -10, -10, -20,
-        -10, 0, 0, 0, 0, 0, 0, -10,
-        -10, 0, 5, 10, 10, 5, 0, -10,
-        -10, 5, 5, 10, 10, 5, 5, -10,
-        -10, 0, 10, 10, 10, 10, 0, -10,
-        -10, 10, 10, 10, 10, 10, 10, -10,
-        -10, 5, 0, 0, 0, 0, 5, -10,
-        -20, -10, -10, -10, -10, -10, -10, -20
-    };
-
-    whiteRookTable = {
-        0, 0, 0, 0, 0, 0, 0, 0,
-        5, 10, 10, 10, 10, 10, 10, 5,
-        -5, 0, 0, 0, 0, 0, 0, -5,
-        -5, 0, 0, 0, 0, 0, 0, -5,
-        -5, 0, 0, 0, 0, 0, 0, -5,
-        -5, 0, 0, 0, 0, 0, 0, -5,
-        -5, 0, 0, 0, 0, 0, 0, -5,
-        0, 0, 0, 5, 5, 0, 0, 0
-    };
-
-    whiteQueenTable = {
-        -20, -10, -10, -5, -5, -10, -10, -20,
-        -10, 0, 0, 0, 0, 0, 0, -10,
-        -10, 0, 5, 5, 5, 5, 0, -10,
-        -5, 0, 5, 5, 5, 5, 0, -5,
-        0, 0, 5, 5, 5, 5, 0, -5,
-        -10, 5, 5, 5, 5, 5, 0, -10,
-        -10, 0, 5, 0, 0, 0, 0, -10,
-        -20, -10, -10, -5, -5, -10, -10, -20
-    };
-
-    // Castling incentives
-    whiteKingTableMG = {
-        -30, -40, -40, -50, -50, -40, -40, -30,
-        -30, -40, -40, -50, -50, -40, -40, -30,
-        -30, -40, -40, -50, -50, -40, -40, -30,
-        -30, -40, -40, -50, -50, -40, -40, -30,
-        -20, -30, -30, -40, -40, -30, -30, -20,
-        -10, -20, -20, -20, -20, -20, -20, -10,
-        20, 20, 0, 0, 0, 0, 20, 20,
-        20, 30, 10, 0, 0, 10, 30, 20
-    };
-
-    whiteKingTableEG = {
-        -50, -40, -30, -20, -20, -30, -40, -50,
-        -30, -20, -10, 0, 0, -10, -20, -30,
-        -30, -10, 20, 30, 30, 20, -10, -30,
-        -30, -10, 30, 40, 40, 30, -10, -30,
-        -30, -10, 30, 40, 40, 30, -10, -30,
-        -30, -10, 20, 30, 30, 20, -10, -30,
-        -30, -30, 0, 0, 0, 0, -30, -30,
-        -50, -30, -30, -30, -30, -30, -30, -50
-    };
-
-    updateBlackTables();
+int Evaluator::evaluateTerminal(const Board& board, const Color side_to_move) {
+    if (board.isCheckmate(side_to_move)) return -MATE_SCORE;
+    return 0;
 }
 
+static constexpr int PST_PARAMS = Evaluator::PST_COUNT + Evaluator::PST_COUNT * 64;
+static constexpr int PARAMS_PER_PHASE = PST_PARAMS + ACTIVITY_COUNT;
+
 int Evaluator::getParameterCount() const {
-    return 6 + 6 * 64; // 6 piece values + 6 tables (P, N, B, R, Q, K_MG)
+    return 2 * PARAMS_PER_PHASE; // per phase: 6 piece values + 6 tables (P, N, B, R, Q, K) + activity terms
 }
 
 int Evaluator::getParameter(int index) const {
-    if (index < 6) return pieceValues[index];
-    index -= 6;
-    if (index < 64) return whitePawnTable[index];
-    index -= 64;
-    if (index < 64) return whiteKnightTable[index];
-    index -= 64;
-    if (index < 64) return whiteBishopTable[index];
-    index -= 64;
-    if (index < 64) return whiteRookTable[index];
-    index -= 64;
-    if (index < 64) return whiteQueenTable[index];
-    index -= 64;
-    if (index < 64) return whiteKingTableMG[index];
-    return 0;
+    if (index < 0 || index >= getParameterCount()) return 0;
+    const int phase = index / PARAMS_PER_PHASE;
+    index %= PARAMS_PER_PHASE;
+    if (index < PST_COUNT) return Psqt::tables.pieceValue[phase][index];
+    if (index >= PST_PARAMS) {
+        const Score w = activity.weights[index - PST_PARAMS];
+        return phase == Psqt::MG ? Psqt::mgValue(w) : Psqt::egValue(w);
+    }
+    index -= PST_COUNT;
+    return Psqt::tables.pieceSquare[phase][index / 64][index % 64];
 }
 
-void Evaluator::setParameter(int index, int value) {
-    if (index < 6) { pieceValues[index] = value; return; }
-    index -= 6;
-    if (index < 64) { whitePawnTable[index] = value; return; }
-    index -= 64;
-    if (index < 64) { whiteKnightTable[index] = value; return; }
-    index -= 64;
-    if (index < 64) { whiteBishopTable[index] = value; return; }
-    index -= 64;
-    if (index < 64) { whiteRookTable[index] = value; return; }
-    index -= 64;
-    if (index < 64) { whiteQueenTable[index] = value; return; }
-    index -= 64;
-    if (index < 64) { whiteKingTableMG[index] = value; return; }
+bool Evaluator::setParameter(int index, int value) {
+    if (index < 0 || index >= getParameterCount()) return false;
+    if (value < std::numeric_limits<int16_t>::min() || value > std::numeric_limits<int16_t>::max()) return false;
+    const int phase = index / PARAMS_PER_PHASE;
+    index %= PARAMS_PER_PHASE;
+    if (index >= PST_PARAMS) {
+        Score& w = activity.weights[index - PST_PARAMS];
+        w = phase == Psqt::MG ? makeScore(value, Psqt::egValue(w)) : makeScore(Psqt::mgValue(w), value);
+        return true;
+    }
+    if (index < PST_COUNT) {
+        Psqt::tables.pieceValue[phase][index] = static_cast<int16_t>(value);
+    }
+    else {
+        index -= PST_COUNT;
+        Psqt::tables.pieceSquare[phase][index / 64][index % 64] = static_cast<int16_t>(value);
+    }
+    Psqt::rebuild();
+    return true;
 }
 
-void Evaluator::updateBlackTables() {
-    auto mirror = [](const std::vector<int>& white, std::vector<int>& black) {
-        black.resize(64);
-        for (int i = 0; i < 64; ++i) {
-            black[i] = white[i ^ 56];
+void Evaluator::getCoefficients(const Board& board, std::vector<Coefficient>& out) const {
+    int counts[PARAMS_PER_PHASE] = {};
+    for (int colour = 0; colour < 2; ++colour) {
+        const int sign = colour == 0 ? 1 : -1;
+        for (int piece = 0; piece < PST_COUNT; ++piece) {
+            uint64_t bb = board.pieceBB(static_cast<Color>(colour), static_cast<Board::PieceIndex>(piece));
+            for (; bb; bb &= bb - 1) {
+                const int sq = __builtin_ctzll(bb);
+                // King material is not part of the score (see Psqt::Tables).
+                if (piece != Board::KING) counts[piece] += sign;
+                counts[PST_COUNT + piece * 64 + (colour == 0 ? sq : sq ^ 56)] += sign;
+            }
         }
-    };
-
-    mirror(whitePawnTable, blackPawnTable);
-    mirror(whiteKnightTable, blackKnightTable);
-    mirror(whiteBishopTable, blackBishopTable);
-    mirror(whiteRookTable, blackRookTable);
-    mirror(whiteQueenTable, blackQueenTable);
-    mirror(whiteKingTableMG, blackKingTableMG);
-    mirror(whiteKingTableEG, blackKingTableEG);
-}
\ No newline at end of file
+    }
+    visitActivity(board, [&](int index, int count) { counts[PST_PARAMS + index] += count; });
+
+    out.clear();
+    for (int i = 0; i < PARAMS_PER_PHASE; ++i) {
+        if (counts[i] != 0) out.push_back({i, counts[i]});
+    }
+}
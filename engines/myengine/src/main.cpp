@@ -1,9 +1,12 @@
 #include "main.h"
 #include "board.h"
 #include "bench.h"
+#include "uciWriter.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <sstream>
 
 using CommandHandler = void(*)(const std::string& line, Engine& engine);
@@ -17,6 +20,8 @@ static void handle_go(const std::string& line, Engine& engine);
 static void handle_bench(const std::string& line, Engine& engine);
 static void handle_eval(const std::string& line, Engine& engine);
 static void handle_setoption(const std::string& line, Engine& engine);
+static void handle_stop(const std::string& line, Engine& engine);
+static void handle_ponderhit(const std::string& line, Engine& engine);
 
 static std::unordered_map<std::string, CommandHandler> UCI_COMMANDS = {
     {"uci", handle_uci},
@@ -28,8 +33,59 @@ static std::unordered_map<std::string, CommandHandler> UCI_COMMANDS = {
     {"bench", handle_bench},
     {"eval", handle_eval},
     {"setoption", handle_setoption},
+    {"stop", handle_stop},
+    {"ponderhit", handle_ponderhit},
 };
 
+// Commands that are answered while a search is running. Anything else waits
+// for the search thread to finish before touching the engine.
+static const std::unordered_set<std::string> ASYNC_SAFE_COMMANDS = {
+    "isready", "stop", "ponderhit", "quit",
+};
+
+// All protocol output goes through one queue: the search thread reports info
+// and bestmove while the command loop may be answering isready, and a slow
+// reader on the other end of the pipe must not stall the search.
+static UciWriter g_writer(std::cout);
+
+static void send_line(const std::string& text) {
+    g_writer.send(text);
+}
+
+static std::string format_score(int score) {
+    const int mateBound = Search::MATE_SCORE - 1000;
+    if (score >= mateBound) {
+        return "mate " + std::to_string((Search::MATE_SCORE - score + 1) / 2);
+    }
+    if (score <= -mateBound) {
+        return "mate -" + std::to_string((Search::MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+static void send_info(const SearchInfo& info) {
+    std::ostringstream line;
+    line << "info depth " << info.depth
+         << " seldepth " << info.selDepth
+         << " multipv " << info.multiPV
+         << " score " << format_score(info.score)
+         << " nodes " << info.nodes
+         << " nps " << (info.nodes * 1000 / std::max<uint64_t>(1, info.timeMs))
+         << " time " << info.timeMs
+         << " hashfull " << info.hashfull;
+    if (!info.pv.empty()) {
+        line << " pv";
+        for (const auto& m : info.pv) line << ' ' << m.toString();
+    }
+    send_line(line.str());
+}
+
+static void send_currmove(int depth, const Move& move, int moveNumber) {
+    send_line("info depth " + std::to_string(depth)
+              + " currmove " + move.toString()
+              + " currmovenumber " + std::to_string(moveNumber));
+}
+
 
 static std::string trim(const std::string& s) {
     const auto first = s.find_first_not_of(" \t\r\n");
@@ -68,32 +124,73 @@ static bool dispatch_uci(const std::string& rawLine, Engine& engine) {
 
     if (cmd.empty()) return true;
 
+    if (!ASYNC_SAFE_COMMANDS.count(cmd)) {
+        engine.waitForSearch();
+    }
+
     auto it = UCI_COMMANDS.find(cmd);
     if (it != UCI_COMMANDS.end()) {
         it->second(line, engine);
     }
     else {
-        std::cout << "no dispatch\n";
+        send_line("no dispatch");
     }
     return cmd != "quit";
 }
 
+// Search tunables exposed as spin options so they can be SPRT-tested from a GUI.
+struct TunableOption {
+    const char* name;
+    int SearchParams::*field;
+    int min;
+    int max;
+};
+
+static const TunableOption SEARCH_TUNABLES[] = {
+    {"LMRBase", &SearchParams::lmrBase, 0, 300},
+    {"LMRDivisor", &SearchParams::lmrDivisor, 50, 600},
+    {"LMRMinDepth", &SearchParams::lmrMinDepth, 1, 10},
+    {"LMRMinMoves", &SearchParams::lmrMinMoves, 1, 20},
+    {"LMRHistoryDivisor", &SearchParams::lmrHistoryDivisor, 256, 65536},
+    {"RFPMaxDepth", &SearchParams::rfpMaxDepth, 0, 16},
+    {"RFPMargin", &SearchParams::rfpMargin, 20, 300},
+    {"RazorMaxDepth", &SearchParams::razorMaxDepth, 0, 8},
+    {"RazorMargin", &SearchParams::razorMargin, 50, 1000},
+    {"FutilityMaxDepth", &SearchParams::futilityMaxDepth, 0, 12},
+    {"FutilityBase", &SearchParams::futilityBase, 0, 500},
+    {"FutilityMargin", &SearchParams::futilityMargin, 20, 300},
+    {"LMPMaxDepth", &SearchParams::lmpMaxDepth, 0, 12},
+    {"MaxExtensions", &SearchParams::maxExtensions, 0, 64},
+    {"SingularMinDepth", &SearchParams::singularMinDepth, 4, 20},
+    {"SingularMargin", &SearchParams::singularMargin, 1, 10},
+    {"IIRMinDepth", &SearchParams::iirMinDepth, 2, 20},
+};
+
 static void handle_uci(const std::string& line, Engine& engine) {
     #ifndef ENGINE_VERSION
     #define ENGINE_VERSION "dev"
     #endif
 
-    std::cout << "id name Chess-Engine v" << ENGINE_VERSION << "\n";
-    std::cout << "id author Antigravity\n";
+    send_line(std::string("id name Chess-Engine v") + ENGINE_VERSION);
+    send_line("id author Antigravity");
 
     // TODO: OwnBook advertises "default true" but is effectively off until a BookFile is
     // loaded. Consider advertising "default false" to match actual behaviour, or set
     // use_book=true only after a successful load (see TODO in main.h).
-    std::cout << "option name OwnBook type check default true\n";
-    std::cout << "option name BookFile type string default \n";
-    std::cout << "option name BookMaxFullmove type spin default 20 min 1 max 200\n";
-    std::cout << "uciok\n";
-    std::cout.flush();
+    send_line("option name OwnBook type check default true");
+    send_line("option name Ponder type check default false");
+    send_line("option name BookFile type string default ");
+    send_line("option name BookMaxFullmove type spin default 20 min 1 max 200");
+    send_line("option name EvalFile type string default ");
+    send_line("option name Threads type spin default " + std::to_string(engine.threads()) + " min 1 max 256");
+    send_line("option name MultiPV type spin default 1 min 1 max 64");
+    send_line("option name RootSplit type check default false");
+    for (const auto& opt : SEARCH_TUNABLES) {
+        send_line(std::string("option name ") + opt.name + " type spin default "
+                  + std::to_string(engine.searchParams().*opt.field)
+                  + " min " + std::to_string(opt.min) + " max " + std::to_string(opt.max));
+    }
+    send_line("uciok");
 }
 
 static void handle_setoption(const std::string& line, Engine& engine) {
@@ -115,42 +212,91 @@ static void handle_setoption(const std::string& line, Engine& engine) {
     if (name == "BookFile") {
         if (value.empty()) {
             engine.getOpeningBook().clear();
-            std::cout << "info string opening book cleared\n";
+            send_line("info string opening book cleared");
         } else if (engine.loadOpeningBook(value)) {
-            std::cout << "info string opening book loaded ("
-                      << engine.getOpeningBook().size() << " entries)\n";
+            send_line("info string opening book loaded ("
+                      + std::to_string(engine.getOpeningBook().size()) + " entries)");
         } else {
-            std::cout << "info string failed to load opening book: " << value << "\n";
+            send_line("info string failed to load opening book: " + value);
         }
     } else if (name == "OwnBook") {
         bool on = (value == "true" || value == "True" || value == "1");
         engine.setUseBook(on);
-        std::cout << "info string OwnBook=" << (on ? "true" : "false") << "\n";
+        send_line(std::string("info string OwnBook=") + (on ? "true" : "false"));
     } else if (name == "BookMaxFullmove") {
         try {
             engine.setBookMaxFullmove(std::stoi(value));
-            std::cout << "info string BookMaxFullmove=" << engine.bookMaxFullmove() << "\n";
+            send_line("info string BookMaxFullmove=" + std::to_string(engine.bookMaxFullmove()));
         } catch (...) {
-            std::cout << "info string invalid BookMaxFullmove\n";
+            send_line("info string invalid BookMaxFullmove");
         }
+    } else if (name == "EvalFile") {
+        if (value.empty()) {
+            engine.clearEvalFile();
+            send_line("info string using handcrafted evaluation");
+        } else if (engine.loadEvalFile(value)) {
+            send_line("info string network loaded: " + value);
+        } else {
+            send_line("info string failed to load network: " + value);
+        }
+    } else if (name == "Ponder") {
+        // Informational only: the GUI decides whether to send "go ponder".
+    } else if (name == "Threads") {
+        try {
+            engine.setThreads(std::clamp(std::stoi(value), 1, 256));
+            send_line("info string Threads=" + std::to_string(engine.threads()));
+        } catch (...) {
+            send_line("info string invalid Threads");
+        }
+    } else if (name == "MultiPV") {
+        try {
+            engine.setMultiPV(std::clamp(std::stoi(value), 1, 64));
+            send_line("info string MultiPV=" + std::to_string(engine.multiPV()));
+        } catch (...) {
+            send_line("info string invalid MultiPV");
+        }
+    } else if (name == "RootSplit") {
+        bool on = (value == "true" || value == "True" || value == "1");
+        engine.setRootSplit(on);
+        send_line(std::string("info string RootSplit=") + (on ? "true" : "false"));
     } else {
-        std::cout << "info string unknown option: " << name << "\n";
+        for (const auto& opt : SEARCH_TUNABLES) {
+            if (name != opt.name) continue;
+            try {
+                SearchParams params = engine.searchParams();
+                params.*opt.field = std::clamp(std::stoi(value), opt.min, opt.max);
+                engine.setSearchParams(params);
+                send_line(std::string("info string ") + opt.name + "="
+                          + std::to_string(engine.searchParams().*opt.field));
+            } catch (...) {
+                send_line(std::string("info string invalid ") + opt.name);
+            }
+            return;
+        }
+        send_line("info string unknown option: " + name);
     }
-    std::cout.flush();
 }
 
 static void handle_isready(const std::string& line, Engine& engine) {
-    std::cout << "readyok\n";
-    std::cout.flush();
+    send_line("readyok");
 }
 
-static void handle_ucinewgame(const std::string& line, Engine& engine) {
-    std::cout << "newgame\n";
-    engine.reset();
-    std::cout.flush();
+static void handle_stop(const std::string& /*line*/, Engine& engine) {
+    engine.stopSearch();
 }
 
-static void handle_quit(const std::string& line, Engine& engine) {}
+static void handle_ponderhit(const std::string& /*line*/, Engine& engine) {
+    engine.ponderhit();
+}
+
+static void handle_ucinewgame(const std::string& /*line*/, Engine& engine) {
+    send_line("newgame");
+    engine.newGame();
+}
+
+static void handle_quit(const std::string& /*line*/, Engine& engine) {
+    engine.stopSearch();
+}
 
 static void handle_position(const std::string& line, Engine& engine) {
     std::string cmd, rest;
@@ -181,8 +327,7 @@ static void handle_position(const std::string& line, Engine& engine) {
 
             bool ok = engine.setPosition(fen.str());
             if (!ok) {
-                std::cout << "info string invalid FEN in position command\n";
-                std::cout.flush();
+                send_line("info string invalid FEN in position command");
             }
         }
     }
@@ -194,8 +339,7 @@ static void handle_position(const std::string& line, Engine& engine) {
         std::string moveUci;
         while (iss >> moveUci) {
             if (!engine.applyMove(moveUci)) {
-                std::cout << "info string failed to apply move " << moveUci << "\n";
-                std::cout.flush();
+                send_line("info string failed to apply move " + moveUci);
                 break;
             }
         }
@@ -205,9 +349,8 @@ static void handle_position(const std::string& line, Engine& engine) {
 static void handle_eval(const std::string& line, Engine& engine) {
     int score = engine.evaluateCurrentPosition();
 
-    std::cout << "Score: " << score << "\n";
-    std::cout << "Eval Complete\n";
-    std::cout.flush();
+    send_line("Score: " + std::to_string(score));
+    send_line("Eval Complete");
 }
 
 static void handle_go(const std::string& line, Engine& engine) {
@@ -217,6 +360,10 @@ static void handle_go(const std::string& line, Engine& engine) {
     settings.increment_ms = 0;
     settings.moves_to_go = 0;
     settings.movetime_ms = 0;
+    settings.infinite = false;
+    settings.ponder = false;
+    settings.nodes = 0;
+    settings.mate = 0;
 
     std::istringstream iss(line);
     std::string token;
@@ -224,10 +371,14 @@ static void handle_go(const std::string& line, Engine& engine) {
     int wtime = 0, btime = 0, winc = 0, binc = 0, movestogo = 0;
     int movetime = 0;
     bool infinite = false;
+    bool depthGiven = false;
 
     while (iss >> token) {
         if (token == "go") continue;
-        if (token == "depth") iss >> settings.depth;
+        if (token == "depth") {
+            iss >> settings.depth;
+            depthGiven = true;
+        }
         else if (token == "wtime") iss >> wtime;
         else if (token == "btime") iss >> btime;
         else if (token == "winc") iss >> winc;
@@ -235,6 +386,9 @@ static void handle_go(const std::string& line, Engine& engine) {
         else if (token == "movestogo") iss >> movestogo;
         else if (token == "movetime") iss >> movetime;
         else if (token == "infinite") infinite = true;
+        else if (token == "ponder") settings.ponder = true;
+        else if (token == "nodes") iss >> settings.nodes;
+        else if (token == "mate") iss >> settings.mate;
     }
 
     bool whiteToMove = true;
@@ -254,15 +408,24 @@ static void handle_go(const std::string& line, Engine& engine) {
     }
 
     if (infinite) {
-        settings.depth = 64;
+        settings.infinite = true;
         settings.time_left_ms = 0;
         settings.movetime_ms = 0;
     }
 
-    // 4. Execute
-    const std::string bestUci = engine.playMove(settings);
-    std::cout << "bestmove " << bestUci << "\n";
-    std::cout.flush();
+    // Ponder and infinite searches run until stopped, and node searches until
+    // their budget is spent; only an explicit depth caps them. Mate searches
+    // also end once the search is deep enough to rule the mate out.
+    if ((infinite || settings.ponder || settings.nodes > 0 || settings.mate > 0) && !depthGiven) {
+        settings.depth = 64;
+    }
+
+    // Search on a separate thread so stop, ponderhit and isready stay responsive.
+    engine.startSearch(settings, [](const std::string& best, const std::string& ponder) {
+        std::string reply = "bestmove " + best;
+        if (!ponder.empty()) reply += " ponder " + ponder;
+        send_line(reply);
+    });
 }
 
 static void handle_bench(const std::string& line, Engine& engine) {
@@ -296,8 +459,13 @@ static void handle_bench(const std::string& line, Engine& engine) {
         else if (token == "nosearch") {
             settings.runSearch = false;
         }
+        else if (token == "smp") {
+            settings.deterministic = false;
+        }
     }
 
+    // Bench prints its tables straight to stdout; keep it behind queued lines.
+    g_writer.flush();
     Bench::run(engine, settings);
 }
 
@@ -307,6 +475,8 @@ int main() {
 
     Engine engine;
     engine.reset();
+    engine.setInfoCallback(send_info);
+    engine.setCurrMoveCallback(send_currmove);
 
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -0,0 +1,223 @@
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using Nnue::HIDDEN;
+using Nnue::INPUTS;
+
+struct alignas(64) Network {
+    int16_t featureWeights[INPUTS][HIDDEN];
+    int16_t featureBias[HIDDEN];
+    int16_t outputWeights[2][HIDDEN];   // [side to move, other side]
+    int32_t outputBias;
+};
+
+// File layout, all little-endian: "MYNN", uint32 version, uint32 hidden
+// size, then featureWeights, featureBias and outputWeights as int16 in the
+// order declared above, then outputBias as int32.
+constexpr char FILE_MAGIC[4] = {'M', 'Y', 'N', 'N'};
+constexpr uint32_t FILE_VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 12;
+constexpr std::size_t WEIGHT_COUNT = INPUTS * HIDDEN + HIDDEN + 2 * HIDDEN;
+constexpr std::size_t FILE_BYTES = HEADER_BYTES + WEIGHT_COUNT * 2 + 4;
+
+Network network;
+uint32_t loadedGeneration = 0;
+uint32_t lastGeneration = 0;
+
+uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0])
+         | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16)
+         | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+int16_t readLE16(const uint8_t* p) {
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0] | (p[1] << 8)));
+}
+
+// Perspective-relative input: the viewer's own pieces first, board flipped
+// for black so both perspectives share one set of weights.
+int featureIndex(int perspective, int colour, int piece, int square) {
+    const int relativeSquare = perspective == 0 ? square : square ^ 56;
+    return ((colour == perspective ? 0 : 6) + piece) * 64 + relativeSquare;
+}
+
+#if defined(__AVX2__)
+#define NNUE_SIMD 1
+using Vec = __m256i;
+constexpr int VEC_WIDTH = 16;
+inline Vec vecLoad(const int16_t* p) { return _mm256_load_si256(reinterpret_cast<const Vec*>(p)); }
+inline void vecStore(int16_t* p, Vec v) { _mm256_store_si256(reinterpret_cast<Vec*>(p), v); }
+inline Vec vecAdd16(Vec a, Vec b) { return _mm256_add_epi16(a, b); }
+inline Vec vecSub16(Vec a, Vec b) { return _mm256_sub_epi16(a, b); }
+inline Vec vecAdd32(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+inline Vec vecZero() { return _mm256_setzero_si256(); }
+inline Vec vecSet16(int v) { return _mm256_set1_epi16(static_cast<int16_t>(v)); }
+inline Vec vecClamp16(Vec v, Vec lo, Vec hi) { return _mm256_min_epi16(_mm256_max_epi16(v, lo), hi); }
+inline Vec vecMulAddPairs(Vec a, Vec b) { return _mm256_madd_epi16(a, b); }
+inline int vecSum32(Vec v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#elif defined(__SSE2__)
+#define NNUE_SIMD 1
+using Vec = __m128i;
+constexpr int VEC_WIDTH = 8;
+inline Vec vecLoad(const int16_t* p) { return _mm_load_si128(reinterpret_cast<const Vec*>(p)); }
+inline void vecStore(int16_t* p, Vec v) { _mm_store_si128(reinterpret_cast<Vec*>(p), v); }
+inline Vec vecAdd16(Vec a, Vec b) { return _mm_add_epi16(a, b); }
+inline Vec vecSub16(Vec a, Vec b) { return _mm_sub_epi16(a, b); }
+inline Vec vecAdd32(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+inline Vec vecZero() { return _mm_setzero_si128(); }
+inline Vec vecSet16(int v) { return _mm_set1_epi16(static_cast<int16_t>(v)); }
+inline Vec vecClamp16(Vec v, Vec lo, Vec hi) { return _mm_min_epi16(_mm_max_epi16(v, lo), hi); }
+inline Vec vecMulAddPairs(Vec a, Vec b) { return _mm_madd_epi16(a, b); }
+inline int vecSum32(Vec v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return _mm_cvtsi128_si32(v);
+}
+#endif
+
+#ifdef NNUE_SIMD
+static_assert(HIDDEN % VEC_WIDTH == 0, "hidden layer must fill whole vectors");
+#endif
+
+int scaleOutput(int64_t sum) {
+    const int64_t cp = (sum + network.outputBias) * Nnue::OUTPUT_SCALE / (Nnue::QA * Nnue::QB);
+    return static_cast<int>(std::clamp<int64_t>(cp, -Nnue::MAX_EVAL, Nnue::MAX_EVAL));
+}
+
+} // namespace
+
+namespace Nnue {
+
+bool load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (buf.size() != FILE_BYTES) return false;
+    if (std::memcmp(buf.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) return false;
+    if (readLE32(buf.data() + 4) != FILE_VERSION) return false;
+    if (readLE32(buf.data() + 8) != static_cast<uint32_t>(HIDDEN)) return false;
+
+    auto next = std::make_unique<Network>();
+    const uint8_t* p = buf.data() + HEADER_BYTES;
+    for (auto& row : next->featureWeights) {
+        for (int16_t& w : row) { w = readLE16(p); p += 2; }
+    }
+    for (int16_t& b : next->featureBias) { b = readLE16(p); p += 2; }
+    for (auto& row : next->outputWeights) {
+        for (int16_t& w : row) { w = readLE16(p); p += 2; }
+    }
+    next->outputBias = static_cast<int32_t>(readLE32(p));
+
+    network = *next;
+    loadedGeneration = ++lastGeneration;
+    return true;
+}
+
+void unload() {
+    loadedGeneration = 0;
+}
+
+uint32_t generation() {
+    return loadedGeneration;
+}
+
+void reset(Accumulator& acc) {
+    for (auto& half : acc.values) {
+        std::memcpy(half, network.featureBias, sizeof(network.featureBias));
+    }
+    acc.generation = loadedGeneration;
+}
+
+void addPiece(Accumulator& acc, int colour, int piece, int square) {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        const int16_t* w = network.featureWeights[featureIndex(perspective, colour, piece, square)];
+        for (int i = 0; i < HIDDEN; ++i) acc.values[perspective][i] += w[i];
+    }
+}
+
+void update(const Accumulator& parent, Accumulator& child, const DirtyPieces& dirty) {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        const int16_t* added[2];
+        const int16_t* removed[2];
+        for (int k = 0; k < dirty.addedCount; ++k) {
+            const auto& pc = dirty.added[k];
+            added[k] = network.featureWeights[featureIndex(perspective, pc.colour, pc.piece, pc.square)];
+        }
+        for (int k = 0; k < dirty.removedCount; ++k) {
+            const auto& pc = dirty.removed[k];
+            removed[k] = network.featureWeights[featureIndex(perspective, pc.colour, pc.piece, pc.square)];
+        }
+
+        const int16_t* from = parent.values[perspective];
+        int16_t* to = child.values[perspective];
+#ifdef NNUE_SIMD
+        for (int i = 0; i < HIDDEN; i += VEC_WIDTH) {
+            Vec v = vecLoad(from + i);
+            for (int k = 0; k < dirty.addedCount; ++k) v = vecAdd16(v, vecLoad(added[k] + i));
+            for (int k = 0; k < dirty.removedCount; ++k) v = vecSub16(v, vecLoad(removed[k] + i));
+            vecStore(to + i, v);
+        }
+#else
+        for (int i = 0; i < HIDDEN; ++i) {
+            int16_t v = from[i];
+            for (int k = 0; k < dirty.addedCount; ++k) v += added[k][i];
+            for (int k = 0; k < dirty.removedCount; ++k) v -= removed[k][i];
+            to[i] = v;
+        }
+#endif
+    }
+    child.generation = parent.generation;
+}
+
+int evaluate(const Accumulator& acc, int sideToMove) {
+#ifdef NNUE_SIMD
+    const Vec lo = vecZero();
+    const Vec hi = vecSet16(QA);
+    Vec sum = vecZero();
+    for (int side = 0; side < 2; ++side) {
+        const int16_t* values = acc.values[side == 0 ? sideToMove : sideToMove ^ 1];
+        const int16_t* weights = network.outputWeights[side];
+        for (int i = 0; i < HIDDEN; i += VEC_WIDTH) {
+            const Vec activation = vecClamp16(vecLoad(values + i), lo, hi);
+            sum = vecAdd32(sum, vecMulAddPairs(activation, vecLoad(weights + i)));
+        }
+    }
+    return scaleOutput(vecSum32(sum));
+#else
+    return evaluateScalar(acc, sideToMove);
+#endif
+}
+
+int evaluateScalar(const Accumulator& acc, int sideToMove) {
+    int64_t sum = 0;
+    for (int side = 0; side < 2; ++side) {
+        const int16_t* values = acc.values[side == 0 ? sideToMove : sideToMove ^ 1];
+        const int16_t* weights = network.outputWeights[side];
+        for (int i = 0; i < HIDDEN; ++i) {
+            sum += std::clamp<int>(values[i], 0, QA) * weights[i];
+        }
+    }
+    return scaleOutput(sum);
+}
+
+} // namespace Nnue
@@ -0,0 +1,194 @@
+#include "psqt.h"
+
+namespace {
+
+using Psqt::MG;
+using Psqt::EG;
+
+constexpr int KING = 5;
+
+constexpr void fillCombined(Psqt::Tables& t) {
+    for (int piece = 0; piece < Psqt::PIECE_TYPES; ++piece) {
+        const int mgMaterial = piece == KING ? 0 : t.pieceValue[MG][piece];
+        const int egMaterial = piece == KING ? 0 : t.pieceValue[EG][piece];
+        for (int sq = 0; sq < 64; ++sq) {
+            t.combined[piece][sq] = Psqt::makeScore(mgMaterial + t.pieceSquare[MG][piece][sq],
+                                                    egMaterial + t.pieceSquare[EG][piece][sq]);
+        }
+    }
+}
+
+constexpr Psqt::Tables makeDefaults() {
+    Psqt::Tables t{
+        {},
+        {{
+            // -----------------------------------------------------------
+            // 1. AGGRESSIVE PAWN TABLE
+            // Logic: Rank 2 is 0. Rank 4 (center) is highly rewarded.
+            // Rank 7 is massive (promotion threat).
+            // -----------------------------------------------------------
+            {
+                0, 0, 0, 0, 0, 0, 0, 0,
+                5, 10, 10, -20, -20, 10, 10, 5,
+                5, -5, 0, 5, 5, 0, -5, 5,
+                0, 0, 10, 40, 40, 10, 0, 0, // Rank 4: +40 for e4/d4 (was 20)
+                5, 5, 20, 60, 60, 20, 5, 5, // Rank 5: +60 for e5/d5
+                10, 10, 30, 80, 80, 30, 10, 10, // Rank 6: Crushing
+                50, 50, 50, 50, 50, 50, 50, 50,
+                0, 0, 0, 0, 0, 0, 0, 0
+            },
+            // Knight
+            {
+                -50, -40, -30, -30, -30, -30, -40, -50,
+                -40, -20, 0, 0, 0, 0, -20, -40,
+                -30, 0, 10, 15, 15, 10, 0, -30,
+                -30, 5, 15, 20, 20, 15, 5, -30,
+                -30, 0, 15, 20, 20, 15, 0, -30,
+                -30, 5, 10, 15, 15, 10, 5, -30,
+                -40, -20, 0, 5, 5, 0, -20, -40,
+                -50, -40, -30, -30, -30, -30, -40, -50
+            },
+            // Bishop
+            {
+                -20, -10, -10, -10, -10, -10, -10, -20,
+                -10, 0, 0, 0, 0, 0, 0, -10,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -10, 5, 5, 10, 10, 5, 5, -10,
+                -10, 0, 10, 10, 10, 10, 0, -10,
+                -10, 10, 10, 10, 10, 10, 10, -10,
+                -10, 5, 0, 0, 0, 0, 5, -10,
+                -20, -10, -10, -10, -10, -10, -10, -20
+            },
+            // Rook
+            {
+                0, 0, 0, 0, 0, 0, 0, 0,
+                5, 10, 10, 10, 10, 10, 10, 5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                0, 0, 0, 5, 5, 0, 0, 0
+            },
+            // Queen
+            {
+                -20, -10, -10, -5, -5, -10, -10, -20,
+                -10, 0, 0, 0, 0, 0, 0, -10,
+                -10, 0, 5, 5, 5, 5, 0, -10,
+                -5, 0, 5, 5, 5, 5, 0, -5,
+                0, 0, 5, 5, 5, 5, 0, -5,
+                -10, 5, 5, 5, 5, 5, 0, -10,
+                -10, 0, 5, 0, 0, 0, 0, -10,
+                -20, -10, -10, -5, -5, -10, -10, -20
+            },
+            // King, midgame: castling incentives
+            {
+                20, 30, 10, 0, 0, 10, 30, 20,
+                20, 20, 0, 0, 0, 0, 20, 20,
+                -10, -20, -20, -20, -20, -20, -20, -10,
+                -20, -30, -30, -40, -40, -30, -30, -20,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30
+            },
+        }, {
+            // Endgame pawns: advancement dominates, centre files keep a small edge.
+            {
+                0, 0, 0, 0, 0, 0, 0, 0,
+                5, 5, 5, 5, 5, 5, 5, 5,
+                10, 10, 10, 15, 15, 10, 10, 10,
+                20, 20, 20, 25, 25, 20, 20, 20,
+                35, 35, 35, 40, 40, 35, 35, 35,
+                60, 60, 60, 65, 65, 60, 60, 60,
+                100, 100, 100, 100, 100, 100, 100, 100,
+                0, 0, 0, 0, 0, 0, 0, 0
+            },
+            // Endgame knight: centralisation only, no development terms.
+            {
+                -50, -40, -30, -30, -30, -30, -40, -50,
+                -40, -20, -10, -5, -5, -10, -20, -40,
+                -30, -10, 10, 15, 15, 10, -10, -30,
+                -30, -5, 15, 20, 20, 15, -5, -30,
+                -30, -5, 15, 20, 20, 15, -5, -30,
+                -30, -10, 10, 15, 15, 10, -10, -30,
+                -40, -20, -10, -5, -5, -10, -20, -40,
+                -50, -40, -30, -30, -30, -30, -40, -50
+            },
+            // Endgame bishop: long diagonals through the centre, corners weak.
+            {
+                -20, -10, -10, -10, -10, -10, -10, -20,
+                -10, -5, 0, 0, 0, 0, -5, -10,
+                -10, 0, 5, 5, 5, 5, 0, -10,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -10, 0, 5, 5, 5, 5, 0, -10,
+                -10, -5, 0, 0, 0, 0, -5, -10,
+                -20, -10, -10, -10, -10, -10, -10, -20
+            },
+            // Endgame rook: the seventh rank cuts off the king and hits pawns from
+            // the side, the own second rank guards pawns and king the same way,
+            // and the a- and h-files keep it far from the kings in the centre.
+            {
+                0, 0, 0, 0, 0, 0, 0, 0,
+                5, 10, 10, 10, 10, 10, 10, 5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                15, 20, 20, 20, 20, 20, 20, 15,
+                0, 0, 0, 0, 0, 0, 0, 0
+            },
+            // Endgame queen: centralise, as the king does.
+            {
+                -20, -10, -10, -5, -5, -10, -10, -20,
+                -10, -5, 0, 0, 0, 0, -5, -10,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -5, 0, 10, 15, 15, 10, 0, -5,
+                -5, 0, 10, 15, 15, 10, 0, -5,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -10, -5, 0, 0, 0, 0, -5, -10,
+                -20, -10, -10, -5, -5, -10, -10, -20
+            },
+            // King, endgame: centralise
+            {
+                -50, -30, -30, -30, -30, -30, -30, -50,
+                -30, -30, 0, 0, 0, 0, -30, -30,
+                -30, -10, 20, 30, 30, 20, -10, -30,
+                -30, -10, 30, 40, 40, 30, -10, -30,
+                -30, -10, 30, 40, 40, 30, -10, -30,
+                -30, -10, 20, 30, 30, 20, -10, -30,
+                -30, -20, -10, 0, 0, -10, -20, -30,
+                -50, -40, -30, -20, -20, -30, -40, -50
+            },
+        }},
+        {
+            {100, 320, 330, 500, 900, 20000},
+            {120, 300, 320, 520, 940, 20000},   // pawns gain and minors lose value as pieces come off
+        }
+    };
+    fillCombined(t);
+    return t;
+}
+
+} // namespace
+
+namespace Psqt {
+
+constexpr Tables DEFAULT_TABLES = makeDefaults();
+
+// A pawn on e4 is worth 100 + 40 in the midgame and 120 + 25 in the endgame.
+static_assert(mgValue(DEFAULT_TABLES.combined[0][28]) == 140 && egValue(DEFAULT_TABLES.combined[0][28]) == 145,
+              "default tables must be generated at compile time");
+
+Tables tables = DEFAULT_TABLES;
+
+void rebuild() {
+    fillCombined(tables);
+}
+
+void resetToDefaults() {
+    tables = DEFAULT_TABLES;
+}
+
+} // namespace Psqt
@@ -1,11 +1,60 @@
 #include "search.h"
+#include "endgame.h"
 #include <algorithm>
 #include <iostream>
 #include <limits>
 #include <cstring>
+#include <cmath>
 
 static constexpr int INF = 1000000;
-static constexpr int MATE_SCORE = 100000;
+
+// Null-move pruning: R = base + depth / divisor + min((eval - beta) / evalDivisor, maxEval).
+static constexpr int NMP_BASE_REDUCTION = 3;
+static constexpr int NMP_DEPTH_DIVISOR = 4;
+static constexpr int NMP_EVAL_DIVISOR = 200;
+static constexpr int NMP_MAX_EVAL_REDUCTION = 3;
+static constexpr int NMP_VERIFY_DEPTH = 10;
+
+// Ordering bonuses for the two killer slots; below captures and promotions.
+static constexpr int KILLER_SCORE_PRIMARY = 80000;
+static constexpr int KILLER_SCORE_SECONDARY = 70000;
+
+// Root moves are announced with "currmove" once an iteration runs this long.
+static constexpr uint64_t CURRMOVE_REPORT_MS = 3000;
+
+// Stand-in deadline for node- and mate-limited searches that have no clock.
+static constexpr uint64_t NO_CLOCK_MS = 24ULL * 60 * 60 * 1000;
+
+// Plies searched past 2N for "go mate N" before concluding there is no such mate.
+static constexpr int MATE_DEPTH_MARGIN = 4;
+
+// Mate scores are stored relative to the node rather than the root, so a
+// mate found at one ply reads back correctly at another.
+static int scoreToTT(int score, int plyFromRoot) {
+    if (score >= Search::MATE_SCORE - Search::MAX_PLY) return score + plyFromRoot;
+    if (score <= -Search::MATE_SCORE + Search::MAX_PLY) return score - plyFromRoot;
+    return score;
+}
+
+static int scoreFromTT(int score, int plyFromRoot) {
+    if (score >= Search::MATE_SCORE - Search::MAX_PLY) return score - plyFromRoot;
+    if (score <= -Search::MATE_SCORE + Search::MAX_PLY) return score + plyFromRoot;
+    return score;
+}
+
+// Distinct TT key for a node searched with one move excluded.
+static uint64_t exclusionKey(uint64_t key, const Move& excluded) {
+    const uint64_t moveBits = static_cast<uint64_t>(excluded.start * 64 + excluded.end)
+                            | (static_cast<uint64_t>(static_cast<unsigned char>(excluded.promo)) << 12);
+    return key ^ ((moveBits + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Material values for delta pruning in quiescence, indexed by Board::PieceIndex.
+static constexpr int DELTA_PIECE_VALUES[] = {100, 320, 330, 500, 900, 0};
+static constexpr int DELTA_MARGIN = 200;
+
+// Once an evasion has avoided mate, only this many quiet evasions are tried.
+static constexpr int QS_MAX_QUIET_EVASIONS = 2;
 
 static int getMvvLvaScore(const Board& board, const Move& move) {
     if (!move.isCapture()) return 0;
@@ -28,26 +77,249 @@ static int getMvvLvaScore(const Board& board, const Move& move) {
 }
 
 Search::Search(const Evaluator& evaluator, TranspositionTable& tt)
-    : evaluator_(evaluator), tt_(tt),
-      numThreads_(std::max(1u, std::thread::hardware_concurrency())) {}
+    : evaluator_(evaluator), tt_(tt) {
+    setParams(SearchParams{});
+    setThreadCount(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+}
+
+Search::~Search() {
+    shutdownPool();
+}
 
 void Search::setThreadCount(int count) {
-    numThreads_ = std::max(1, count);
+    count = std::max(1, count);
+    if (count == numThreads_) return;
+
+    shutdownPool();
+
+    // Surviving workers keep their history; only new slots start clean.
+    const size_t oldSize = workers_.size();
+    workers_.resize(count);
+    for (size_t i = oldSize; i < workers_.size(); ++i) {
+        workers_[i] = std::make_unique<WorkerState>();
+        workers_[i]->reset();
+    }
+
+    numThreads_ = count;
+    exiting_ = false;
+    threads_.reserve(count - 1);
+    for (int i = 1; i < count; ++i) {
+        threads_.emplace_back(&Search::idleLoop, this, i, searchGeneration_);
+    }
+}
+
+void Search::setParams(const SearchParams& params) {
+    params_ = params;
+    params_.lmrDivisor = std::max(1, params_.lmrDivisor);
+    params_.lmrHistoryDivisor = std::max(1, params_.lmrHistoryDivisor);
+
+    const double base = params_.lmrBase / 100.0;
+    const double divisor = params_.lmrDivisor / 100.0;
+    for (int d = 0; d < 64; ++d) {
+        for (int m = 0; m < 64; ++m) {
+            lmrTable_[d][m] = (d == 0 || m == 0)
+                ? 0
+                : std::max(0, static_cast<int>(base + std::log(d) * std::log(m) / divisor));
+        }
+    }
+}
+
+int Search::lateMoveReduction(int depth, int moveNumber) const {
+    return lmrTable_[std::clamp(depth, 0, 63)][std::clamp(moveNumber, 0, 63)];
+}
+
+void Search::setMultiPV(int lines) {
+    multiPV_ = std::max(1, lines);
+}
+
+void Search::clearHistory() {
+    for (auto& ws : workers_) ws->reset();
+}
+
+void Search::shutdownPool() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        exiting_ = true;
+    }
+    wakeCv_.notify_all();
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+}
+
+void Search::idleLoop(int threadId, uint64_t seenGeneration) {
+    while (true) {
+        int maxDepth;
+        bool rootSplit;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex_);
+            wakeCv_.wait(lock, [&] { return exiting_ || searchGeneration_ != seenGeneration; });
+            if (exiting_) return;
+            seenGeneration = searchGeneration_;
+            maxDepth = jobMaxDepth_;
+            rootSplit = jobRootSplit_;
+        }
+
+        if (rootSplit) {
+            splitRootMoves(*workers_[threadId], workers_[threadId]->board);
+        }
+        else {
+            helperThreadMain(*workers_[threadId], maxDepth, threadId);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex_);
+            if (--busyHelpers_ == 0) doneCv_.notify_all();
+        }
+    }
+}
+
+void Search::startHelpers(const Board& board, int maxDepth, bool rootSplit) {
+    if (threads_.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        // Helpers are parked, so their boards can be refreshed without racing.
+        for (int i = 1; i < numThreads_; ++i) workers_[i]->board = board;
+        jobMaxDepth_ = maxDepth;
+        jobRootSplit_ = rootSplit;
+        busyHelpers_ = static_cast<int>(threads_.size());
+        ++searchGeneration_;
+    }
+    wakeCv_.notify_all();
+}
+
+void Search::waitForHelpers() {
+    std::unique_lock<std::mutex> lock(poolMutex_);
+    doneCv_.wait(lock, [&] { return busyHelpers_ == 0; });
 }
 
 bool Search::shouldStop() const {
-    return stopFlag_.load(std::memory_order_relaxed) || tm_.isHardTimeUp();
+    if (stopFlag_.load(std::memory_order_relaxed)) return true;
+    // Checked against published counts so it is safe from any thread. With one
+    // thread the checks land on the same node numbers every run.
+    if (nodeLimit_ > 0 && publishedNodes() >= nodeLimit_) return true;
+    return !ignoresClock() && tm_.isHardTimeUp();
 }
 
-Move Search::findBestMove(Board& board, int maxDepth, int timeLeftMs, int incrementMs, int movesToGo, int movetimeMs) {
-    aggregateStats_.reset();
+void Search::resetSignals(bool ponder) {
+    std::lock_guard<std::mutex> lock(signalMutex_);
     stopFlag_.store(false, std::memory_order_relaxed);
+    pondering_.store(ponder, std::memory_order_relaxed);
+}
 
-    if (movetimeMs > 0) {
-        tm_.startFixed(static_cast<uint64_t>(movetimeMs));
+void Search::stop() {
+    {
+        std::lock_guard<std::mutex> lock(signalMutex_);
+        stopFlag_.store(true, std::memory_order_relaxed);
     }
-    else if (timeLeftMs > 0) {
-        tm_.start(timeLeftMs, incrementMs, movesToGo);
+    signalCv_.notify_all();
+}
+
+void Search::ponderhit() {
+    // The clock was started at "go ponder", so the time spent pondering counts
+    // against the budget once we switch to normal time management.
+    {
+        std::lock_guard<std::mutex> lock(signalMutex_);
+        pondering_.store(false, std::memory_order_relaxed);
+    }
+    signalCv_.notify_all();
+}
+
+void Search::waitForStopOrPonderhit() {
+    std::unique_lock<std::mutex> lock(signalMutex_);
+    signalCv_.wait(lock, [&] {
+        return stopFlag_.load(std::memory_order_relaxed) || !ignoresClock();
+    });
+}
+
+std::vector<Move> Search::extractPV(Board& board, const Move& bestMove, int maxLength) const {
+    std::vector<Move> pv;
+    std::vector<uint64_t> seenKeys;
+
+    if (!board.makeMove(bestMove)) return pv;
+    pv.push_back(bestMove);
+
+    // Follow TT best moves, accepting only legal ones and stopping at a cycle.
+    TranspositionTable::TTEntry ent;
+    while (static_cast<int>(pv.size()) < maxLength && tt_.probe(board.zobristKey(), ent)) {
+        if (std::find(seenKeys.begin(), seenKeys.end(), board.zobristKey()) != seenKeys.end()) break;
+        seenKeys.push_back(board.zobristKey());
+
+        const auto legal = board.generateLegalMoves();
+        if (std::find(legal.begin(), legal.end(), ent.bestMove) == legal.end()) break;
+
+        board.makeMove(ent.bestMove);
+        pv.push_back(ent.bestMove);
+    }
+
+    for (size_t i = 0; i < pv.size(); ++i) board.unmakeMove();
+    return pv;
+}
+
+uint64_t Search::nodesSearched() const {
+    // Only called from the main search thread, so its own count is exact.
+    uint64_t nodes = static_cast<uint64_t>(workers_[0]->stats.totalNodes);
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        nodes += workers_[i]->publishedNodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+uint64_t Search::publishedNodes() const {
+    uint64_t nodes = 0;
+    for (const auto& ws : workers_) {
+        nodes += ws->publishedNodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+void Search::reportIteration(Board& board, int depth, int multiPV, int score, const Move& bestMove) const {
+    if (!infoCallback_) return;
+
+    SearchInfo info;
+    info.depth = depth;
+    info.multiPV = multiPV;
+    info.selDepth = workers_[0]->selDepth;
+    info.score = score;
+    info.nodes = nodesSearched();
+    info.timeMs = tm_.elapsedMs();
+    info.hashfull = tt_.hashfull();
+    info.pv = extractPV(board, bestMove, depth);
+    infoCallback_(info);
+}
+
+Move Search::findBestMove(Board& board, int maxDepth, int timeLeftMs, int incrementMs, int movesToGo, int movetimeMs) {
+    SearchLimits limits;
+    limits.depth = maxDepth;
+    limits.timeLeftMs = timeLeftMs;
+    limits.incrementMs = incrementMs;
+    limits.movesToGo = movesToGo;
+    limits.movetimeMs = movetimeMs;
+
+    resetSignals();
+    return findBestMove(board, limits);
+}
+
+Move Search::findBestMove(Board& board, const SearchLimits& limits) {
+    aggregateStats_.reset();
+    ponderMove_ = Move();
+    infinite_ = limits.infinite;
+    nodeLimit_ = limits.nodes;
+    // Mate in N moves is a score of MATE_SCORE - (2N - 1) or better. It shows
+    // by depth 2N - 1; the margin covers reductions along the mating line, and
+    // a search that gets past it without the mate gives up.
+    const int mateTarget = limits.mate > 0 ? MATE_SCORE - (2 * limits.mate - 1) : INF;
+    const int maxDepth = limits.mate > 0 ? std::min(limits.depth, 2 * limits.mate + MATE_DEPTH_MARGIN) : limits.depth;
+
+    if (limits.movetimeMs > 0) {
+        tm_.startFixed(static_cast<uint64_t>(limits.movetimeMs));
+    }
+    else if (limits.timeLeftMs > 0) {
+        tm_.start(limits.timeLeftMs, limits.incrementMs, limits.movesToGo);
+    }
+    else if (limits.nodes > 0 || limits.mate > 0) {
+        // Node and mate budgets stand in for the clock.
+        tm_.startFixed(NO_CLOCK_MS);
     }
     else {
         tm_.start(50000, 0, 0);
@@ -62,147 +334,260 @@ Move Search::findBestMove(Board& board, int maxDepth, int timeLeftMs, int increm
     Move bestMove = rootMoves[0];
     Move prevBestMove;
     bool hasPrevBest = false;
-
-    std::vector<WorkerState> workers(numThreads_);
-    for (auto& ws : workers) ws.reset();
-
-    std::vector<std::thread> helpers;
-    helpers.reserve(numThreads_ - 1);
-    for (int i = 1; i < numThreads_; ++i) {
-        helpers.emplace_back(&Search::helperThreadMain, this, std::ref(workers[i]), Board(board), maxDepth, i);
+    const int lineCount = std::min(multiPV_, static_cast<int>(rootMoves.size()));
+    rootLines_.clear();
+
+    for (auto& ws : workers_) {
+        ws->stats.reset();
+        ws->clearEvalCache();
+        ws->selDepth = 0;
+        ws->nmpMinPly = 0;
+        for (auto& ss : ws->stack) {
+            ss.staticEval = -INF;
+            ss.excludedMove = Move();
+        }
+        ws->publishNodes();
     }
+    WorkerState& mainWorker = *workers_[0];
+
+    // Root splitting wakes the helpers once per iteration instead.
+    const bool splitRoot = rootSplit_ && numThreads_ > 1 && lineCount == 1;
+    if (!splitRoot) startHelpers(board, maxDepth);
 
     for (int depth = 1; depth <= maxDepth; ++depth) {
         if (shouldStop()) break;
-        if (depth > 1 && tm_.isSoftTimeUp()) break;
-
-        int alpha = -INF;
-        int beta = INF;
-
-        orderMoves(workers[0], board, rootMoves, bestMove);
-
-        Move currentBestMove;
-        int currentBestScore = -INF;
-        bool foundLegalMove = false;
-
-        for (const auto& move : rootMoves) {
-            if (!board.makeMove(move)) {
-                continue;
-            }
-
-            if (!foundLegalMove) {
-                currentBestMove = move;
-                foundLegalMove = true;
-            }
-
-            int score = -negamax(workers[0], board, depth - 1, -beta, -alpha, 1);
-            board.unmakeMove();
-
-            if (shouldStop()) break;
-
-            if (score > currentBestScore) {
-                currentBestScore = score;
-                currentBestMove = move;
-            }
-
-            if (score > alpha) {
-                alpha = score;
-            }
+        if (depth > 1 && !ignoresClock() && tm_.isSoftTimeUp()) break;
+
+        orderMoves(mainWorker, board, rootMoves, bestMove, 0);
+
+        // MultiPV: each pass re-searches the root without the moves already
+        // ranked this iteration. Later passes reuse the TT filled by earlier
+        // ones (and by the helpers), so they are far cheaper than fresh searches.
+        std::vector<RootLine> lines;
+        std::vector<Move> excluded;
+        for (int pvIdx = 0; pvIdx < lineCount; ++pvIdx) {
+            Move lineMove;
+            int score = splitRoot
+                ? searchRootSplit(mainWorker, board, rootMoves, depth, lineMove)
+                : searchRoot(mainWorker, board, rootMoves, depth, excluded, lineMove, true);
+            if (shouldStop() || !lineMove.isValid()) break;
+
+            excluded.push_back(lineMove);
+            lines.push_back({lineMove, score});
         }
 
-        if (!shouldStop() && foundLegalMove) {
-            bestMove = currentBestMove;
+        if (!shouldStop() && static_cast<int>(lines.size()) == lineCount) {
+            std::stable_sort(lines.begin(), lines.end(), [](const RootLine& a, const RootLine& b) {
+                return a.score > b.score;
+            });
+            rootLines_ = lines;
+
+            bestMove = lines[0].move;
             const bool changed = hasPrevBest && !(bestMove == prevBestMove);
             tm_.onIterationComplete(changed);
             prevBestMove = bestMove;
             hasPrevBest = true;
+
+            for (int i = 0; i < lineCount; ++i) {
+                reportIteration(board, depth, i + 1, lines[i].score, lines[i].move);
+            }
+
+            if (lines[0].score >= mateTarget) break;
         }
     }
 
+    // UCI: an infinite or ponder search must not report bestmove on its own.
+    waitForStopOrPonderhit();
+
     stopFlag_.store(true, std::memory_order_relaxed);
 
-    for (auto& t : helpers) t.join();
+    waitForHelpers();
 
-    for (const auto& ws : workers) {
-        aggregateStats_ += ws.stats;
+    for (const auto& ws : workers_) {
+        aggregateStats_ += ws->stats;
     }
 
+    const auto pv = extractPV(board, bestMove, 2);
+    if (pv.size() > 1) ponderMove_ = pv[1];
     return bestMove;
 }
 
-void Search::helperThreadMain(WorkerState& ws, Board board, int maxDepth, int threadId) {
+void Search::helperThreadMain(WorkerState& ws, int maxDepth, int threadId) {
+    Board& board = ws.board;
     auto moves = board.generateLegalMoves();
     if (moves.empty()) return;
 
     Move localBest;
-    bool foundAnyLegal = false;
+    const std::vector<Move> noExclusions;
 
     int startDepth = 1 + (threadId % 2);
 
     for (int depth = startDepth; depth <= maxDepth; ++depth) {
         if (shouldStop()) break;
 
-        int alpha = -INF;
-        int beta = INF;
-
-        orderMoves(ws, board, moves, localBest);
+        orderMoves(ws, board, moves, localBest, 0);
 
         Move currentBest;
-        int currentBestScore = -INF;
-        bool foundLegalMove = false;
+        searchRoot(ws, board, moves, depth, noExclusions, currentBest, false);
 
-        for (const auto& move : moves) {
-            if (!board.makeMove(move)) {
-                continue;
-            }
+        if (!shouldStop() && currentBest.isValid()) {
+            localBest = currentBest;
+        }
+    }
+}
 
-            if (!foundLegalMove) {
-                currentBest = move;
-                foundLegalMove = true;
+int Search::searchRoot(WorkerState& ws, Board& board, std::vector<Move>& moves, int depth,
+                       const std::vector<Move>& excluded, Move& bestMove, bool isMainThread) {
+    int alpha = -INF;
+    int beta = INF;
+    int bestScore = -INF;
+    int moveNumber = 0;
 
-                if (!foundAnyLegal) {
-                    localBest = move;
-                    foundAnyLegal = true;
-                }
-            }
+    for (const auto& move : moves) {
+        if (std::find(excluded.begin(), excluded.end(), move) != excluded.end()) {
+            continue;
+        }
+        if (!board.makeMove(move)) {
+            continue;
+        }
+        ++moveNumber;
 
-            int score = -negamax(ws, board, depth - 1, -beta, -alpha, 1);
-            board.unmakeMove();
+        if (!bestMove.isValid()) {
+            bestMove = move;
+        }
 
-            if (shouldStop()) break;
+        if (isMainThread && currMoveCallback_ && tm_.elapsedMs() >= CURRMOVE_REPORT_MS) {
+            currMoveCallback_(depth, move, moveNumber);
+        }
 
-            if (score > currentBestScore) {
-                currentBestScore = score;
-                currentBest = move;
-            }
+        ws.stack[0].currentMove = move;
+        ws.stack[1].extensions = 0;
+        ws.stack[1].inCheck = board.inCheck(board.sideToMove());
 
-            if (score > alpha) {
-                alpha = score;
+        // PVS: only the first move gets the full window; the rest must prove
+        // they beat it with a null window before being re-searched.
+        int score;
+        if (moveNumber == 1) {
+            score = -negamax(ws, board, depth - 1, -beta, -alpha, 1);
+        }
+        else {
+            score = -negamax(ws, board, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta && !shouldStop()) {
+                score = -negamax(ws, board, depth - 1, -beta, -alpha, 1);
             }
         }
+        board.unmakeMove();
 
-        if (!shouldStop() && foundLegalMove) {
-            localBest = currentBest;
+        if (shouldStop()) break;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+
+        if (score > alpha) {
+            alpha = score;
+        }
+    }
+
+    return bestScore;
+}
+
+int Search::searchRootSplit(WorkerState& ws, Board& board, const std::vector<Move>& moves, int depth,
+                            Move& bestMove) {
+    // Young brothers wait: the first move is searched alone, so the split
+    // starts from a real alpha rather than a full window.
+    const Move& first = moves[0];
+    board.makeMove(first);
+    ws.stack[0].currentMove = first;
+    ws.stack[1].extensions = 0;
+    ws.stack[1].inCheck = board.inCheck(board.sideToMove());
+    const int firstScore = -negamax(ws, board, depth - 1, -INF, INF, 1);
+    board.unmakeMove();
+
+    bestMove = first;
+    if (shouldStop() || moves.size() == 1) return firstScore;
+
+    split_.moves = moves;
+    split_.depth = depth;
+    split_.nextMove.store(1, std::memory_order_relaxed);
+    split_.alpha.store(firstScore, std::memory_order_relaxed);
+    split_.bestMove = first;
+    split_.bestScore = firstScore;
+
+    startHelpers(board, depth, true);
+    splitRootMoves(ws, board);
+    waitForHelpers();
+
+    bestMove = split_.bestMove;
+    return split_.bestScore;
+}
+
+void Search::splitRootMoves(WorkerState& ws, Board& board) {
+    const int depth = split_.depth;
+
+    for (size_t i = split_.nextMove.fetch_add(1, std::memory_order_relaxed); i < split_.moves.size();
+         i = split_.nextMove.fetch_add(1, std::memory_order_relaxed)) {
+        const Move& move = split_.moves[i];
+        if (!board.makeMove(move)) continue;
+
+        ws.stack[0].currentMove = move;
+        ws.stack[1].extensions = 0;
+        ws.stack[1].inCheck = board.inCheck(board.sideToMove());
+
+        // Null window against the best score so far, which other threads may
+        // have raised meanwhile; only a move that beats it gets an exact score.
+        const int alpha = split_.alpha.load(std::memory_order_relaxed);
+        int score = -negamax(ws, board, depth - 1, -alpha - 1, -alpha, 1);
+        if (score > alpha && !shouldStop()) {
+            score = -negamax(ws, board, depth - 1, -INF, -alpha, 1);
+        }
+        board.unmakeMove();
+
+        if (shouldStop()) return;
+
+        std::lock_guard<std::mutex> lock(split_.mutex);
+        if (score > split_.bestScore) {
+            split_.bestScore = score;
+            split_.bestMove = move;
+            split_.alpha.store(score, std::memory_order_relaxed);
         }
     }
 }
 
 int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int beta, int plyFromRoot) {
-    ws.stats.totalNodes++;
+    SearchStack* ss = &ws.stack[plyFromRoot];
 
-    int oldAlpha = alpha;
+    ws.stats.totalNodes++;
+    if (plyFromRoot > ws.selDepth) ws.selDepth = plyFromRoot;
 
-    if ((ws.stats.totalNodes & 2047) == 0 && shouldStop()) return 0;
+    // Measured from the last publish rather than masked: quiescence nodes
+    // advance the count too and could step over a multiple of 2048.
+    if (static_cast<uint64_t>(ws.stats.totalNodes) - ws.publishedNodes.load(std::memory_order_relaxed) >= 2048) {
+        ws.publishNodes();
+        if (shouldStop()) return 0;
+    }
 
-    if (plyFromRoot > 0 && (board.isThreefoldRepetition() || board.isFiftyMoveDraw())) {
+    if (plyFromRoot > 0 && (board.isRepetition(plyFromRoot) || board.isFiftyMoveDraw())) {
         return 0;
     }
 
-    uint64_t key = board.zobristKey();
+    // Mate-distance pruning: nothing found here can beat a mate already
+    // proven closer to the root, nor be worse than being mated right now.
+    alpha = std::max(alpha, -MATE_SCORE + plyFromRoot);
+    beta = std::min(beta, MATE_SCORE - plyFromRoot - 1);
+    if (alpha >= beta) return alpha;
+
+    int oldAlpha = alpha;
+
+    const bool singularSearch = ss->excludedMove.isValid();
+    uint64_t key = singularSearch ? exclusionKey(board.zobristKey(), ss->excludedMove) : board.zobristKey();
     TranspositionTable::TTEntry ent;
     Move ttMove = Move();
+    const bool ttHit = tt_.probe(key, ent);
+    if (ttHit) ent.value = scoreFromTT(ent.value, plyFromRoot);
 
-    if (tt_.probe(key, ent)) {
+    if (ttHit) {
         ttMove = ent.bestMove;
         ws.stats.ttProbes++;
 
@@ -215,63 +600,214 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
         }
     }
 
-    if (depth == 0) {
+    if (depth <= 0 || plyFromRoot >= MAX_PLY - 1) {
         return quiescence(ws, board, alpha, beta, plyFromRoot);
     }
 
-    if (depth >= 3 && !board.inCheck(board.sideToMove()) && plyFromRoot > 0 && beta < MATE_SCORE) {
-        bool hasBigPieces = board.occupancy(board.sideToMove()) & ~board.pieceBB(board.sideToMove(), Board::PAWN);
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = ss->inCheck;
+    int staticEval = -INF;
+    if (!inCheck) {
+        staticEval = (ttHit && ent.staticEval != TranspositionTable::NO_EVAL)
+            ? ent.staticEval
+            : staticEvaluation(ws, board);
+    }
+    ss->staticEval = staticEval;
+
+    // A TT bound on the searched score is a better estimate than the raw eval
+    // when it points the same way.
+    int pruneEval = staticEval;
+    if (!inCheck && ttHit && std::abs(ent.value) < MATE_SCORE - MAX_PLY) {
+        if (ent.flag == TranspositionTable::EXACT
+            || (ent.flag == TranspositionTable::LOWERBOUND && ent.value > staticEval)
+            || (ent.flag == TranspositionTable::UPPERBOUND && ent.value < staticEval)) {
+            pruneEval = ent.value;
+        }
+    }
 
-        if (hasBigPieces) {
-            board.makeNullMove();
+    // Improving: our eval rose since our previous move, so cutoffs are more likely.
+    const bool improving = !inCheck && plyFromRoot >= 2
+        && (ss - 2)->staticEval != -INF && staticEval > (ss - 2)->staticEval;
+
+    (ss + 1)->killers[0] = (ss + 1)->killers[1] = Move();
+
+    // Reverse futility: far enough above beta that a quiet move is unlikely to fall back.
+    if (!pvNode && !inCheck && !singularSearch && depth <= params_.rfpMaxDepth && std::abs(beta) < MATE_SCORE - MAX_PLY
+        && pruneEval - params_.rfpMargin * (depth - (improving ? 1 : 0)) >= beta) {
+        ws.stats.rfpPrunes++;
+        return pruneEval;
+    }
 
-            int R = 2;
+    // Razoring: hopelessly below alpha, so only tactics could help; let q-search decide.
+    // Not against a known win: the quiet move that mates is what beats it.
+    if (!pvNode && !inCheck && !singularSearch && depth <= params_.razorMaxDepth
+        && std::abs(alpha) < Endgame::KNOWN_WIN && pruneEval + params_.razorMargin * depth < alpha) {
+        int score = quiescence(ws, board, alpha - 1, alpha, plyFromRoot);
+        if (score < alpha) {
+            ws.stats.razorPrunes++;
+            return score;
+        }
+    }
+
+    // Internal iterative reduction: without a TT move the ordering is poor, so
+    // search shallower now and let the next iteration find the move.
+    if (depth >= params_.iirMinDepth && !ttMove.isValid() && !singularSearch) {
+        depth--;
+    }
 
-            int score = -negamax(ws, board, depth - 1 - R, -beta, -beta + 1, plyFromRoot + 1);
+    // Null-move pruning. Skipped without non-pawn material (zugzwang risk), inside
+    // a verification search, and when the static eval is already below beta.
+    if (depth >= 3 && plyFromRoot > 0 && plyFromRoot >= ws.nmpMinPly && std::abs(beta) < MATE_SCORE - MAX_PLY && !singularSearch
+        && board.hasNonPawnMaterial(board.sideToMove()) && !inCheck) {
+        if (staticEval >= beta) {
+            // Reduce more at higher depth and the further the eval is above beta.
+            int R = NMP_BASE_REDUCTION + depth / NMP_DEPTH_DIVISOR
+                  + std::min((staticEval - beta) / NMP_EVAL_DIVISOR, NMP_MAX_EVAL_REDUCTION);
+            int nullDepth = std::max(0, depth - 1 - R);
 
+            ss->currentMove = Move();
+            (ss + 1)->extensions = ss->extensions;
+            (ss + 1)->inCheck = false;
+
+            board.makeNullMove();
+            int score = -negamax(ws, board, nullDepth, -beta, -beta + 1, plyFromRoot + 1);
             board.unmakeNullMove();
 
             if (shouldStop()) return 0;
 
             if (score >= beta) {
-                return beta;
+                // Unproven mates from a null search are not trusted.
+                if (score >= MATE_SCORE - MAX_PLY) score = beta;
+
+                if (depth < NMP_VERIFY_DEPTH) return score;
+
+                // Verification: re-search this node without null moves for the
+                // first part of the subtree, so zugzwang cannot fake a cutoff.
+                // Restored afterwards: this may be nested inside an outer
+                // verification whose window must stay in force.
+                const int outerMinPly = ws.nmpMinPly;
+                ws.nmpMinPly = plyFromRoot + 3 * nullDepth / 4;
+                int verified = negamax(ws, board, nullDepth, beta - 1, beta, plyFromRoot);
+                ws.nmpMinPly = outerMinPly;
+
+                if (shouldStop()) return 0;
+                if (verified >= beta) return score;
             }
         }
     }
 
     auto moves = board.generatePseudoMoves();
 
-    orderMoves(ws, board, moves, ttMove);
+    orderMoves(ws, board, moves, ttMove, plyFromRoot);
 
+    const int side = static_cast<int>(board.sideToMove());
     int bestScore = -INF;
     Move bestMoveInNode;
     int movesSearched = 0;
 
+    const bool futile = !inCheck && depth <= params_.futilityMaxDepth && std::abs(alpha) < Endgame::KNOWN_WIN
+        && pruneEval + params_.futilityBase + params_.futilityMargin * depth <= alpha;
+    const int lmpLimit = (3 + depth * depth) * (improving ? 2 : 1);
+
+    const bool canExtend = ss->extensions < params_.maxExtensions;
+
     for (const auto& move : moves) {
+        if (singularSearch && move == ss->excludedMove) {
+            continue;
+        }
+
+        int extension = 0;
+
+        // Singular extension: if every alternative fails well below the TT score,
+        // the TT move is forced and deserves an extra ply. If even the reduced
+        // search without it beats beta, several moves cut and the node can go.
+        if (canExtend && !singularSearch && move == ttMove && depth >= params_.singularMinDepth
+            && ttHit && ent.flag != TranspositionTable::UPPERBOUND && ent.depth >= depth - 3
+            && std::abs(ent.value) < MATE_SCORE - MAX_PLY) {
+            const int singularBeta = ent.value - params_.singularMargin * depth;
+            ss->excludedMove = move;
+            const int singularScore = negamax(ws, board, (depth - 1) / 2, singularBeta - 1, singularBeta,
+                                              plyFromRoot);
+            ss->excludedMove = Move();
+            if (shouldStop()) return 0;
+
+            if (singularScore < singularBeta) {
+                extension = 1;
+                ws.stats.singularExtensions++;
+            }
+            else if (singularBeta >= beta) {
+                return singularBeta;
+            }
+        }
+
         if (!board.makeMove(move)) {
             continue;
         }
 
+        const bool givesCheck = board.inCheck(board.sideToMove());
+
+        if (canExtend && extension == 0) {
+            const Move& previous = (ss - 1)->currentMove;
+            if (givesCheck) {
+                extension = 1;
+                ws.stats.checkExtensions++;
+            }
+            else if (pvNode && move.isCapture() && previous.isCapture() && move.end == previous.end) {
+                extension = 1;
+                ws.stats.recaptureExtensions++;
+            }
+        }
+
+        ss->currentMove = move;
+        (ss + 1)->extensions = ss->extensions + extension;
+        (ss + 1)->inCheck = givesCheck;
+        const int newDepth = depth - 1 + extension;
+
+        // Shallow quiet-move pruning, once a move has been searched so a mate
+        // or stalemate can still be told apart from a pruned node.
+        if (movesSearched > 0 && !inCheck && bestScore > -MATE_SCORE + MAX_PLY
+            && !move.isCapture() && move.type != MoveType::PROMOTION && !givesCheck) {
+            if (futile) {
+                board.unmakeMove();
+                ws.stats.futilityPrunes++;
+                continue;
+            }
+            if (depth <= params_.lmpMaxDepth && movesSearched >= lmpLimit) {
+                board.unmakeMove();
+                ws.stats.lmpPrunes++;
+                continue;
+            }
+        }
+
         int score;
 
         if (movesSearched == 0) {
-            score = -negamax(ws, board, depth - 1, -beta, -alpha, plyFromRoot + 1);
+            score = -negamax(ws, board, newDepth, -beta, -alpha, plyFromRoot + 1);
         }
         else {
             int reduction = 0;
-            if (depth >= 3 && movesSearched >= 4 && !move.isCapture() && !board.inCheck(board.sideToMove())) {
-                reduction = 2;
-                if (depth - 1 - reduction <= 0) reduction = depth - 2;
+            if (depth >= params_.lmrMinDepth && movesSearched >= params_.lmrMinMoves && !inCheck
+                && !move.isCapture() && move.type != MoveType::PROMOTION) {
+                reduction = lateMoveReduction(depth, movesSearched + 1);
+
+                if (!pvNode) reduction++;
+                if (!improving) reduction++;
+                if (givesCheck) reduction--;
+                if (move == ss->killers[0] || move == ss->killers[1]) reduction--;
+                reduction -= ws.history[side][move.start][move.end] / params_.lmrHistoryDivisor;
+
+                // Never drop straight into quiescence.
+                reduction = std::clamp(reduction, 0, std::max(0, newDepth - 1));
             }
 
-            score = -negamax(ws, board, depth - 1 - reduction, -alpha - 1, -alpha, plyFromRoot + 1);
+            score = -negamax(ws, board, newDepth - reduction, -alpha - 1, -alpha, plyFromRoot + 1);
 
             if (score > alpha && reduction > 0) {
-                score = -negamax(ws, board, depth - 1, -alpha - 1, -alpha, plyFromRoot + 1);
+                score = -negamax(ws, board, newDepth, -alpha - 1, -alpha, plyFromRoot + 1);
             }
 
             if (score > alpha && score < beta) {
-                score = -negamax(ws, board, depth - 1, -beta, -alpha, plyFromRoot + 1);
+                score = -negamax(ws, board, newDepth, -beta, -alpha, plyFromRoot + 1);
             }
         }
 
@@ -292,7 +828,11 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
                 if (movesSearched == 0) ws.stats.firstMoveCutoffs++;
 
                 if (!move.isCapture()) {
-                    int side = static_cast<int>(board.sideToMove());
+                    if (!(move == ss->killers[0])) {
+                        ss->killers[1] = ss->killers[0];
+                        ss->killers[0] = move;
+                    }
+
                     ws.history[side][move.start][move.end] += depth * depth;
 
                     if (ws.history[side][move.start][move.end] > 10000000) {
@@ -300,7 +840,7 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
                     }
                 }
 
-                tt_.store(key, beta, depth, move, TranspositionTable::LOWERBOUND);
+                tt_.store(key, scoreToTT(beta, plyFromRoot), depth, move, TranspositionTable::LOWERBOUND, inCheck ? TranspositionTable::NO_EVAL : staticEval);
                 return beta;
             }
         }
@@ -308,7 +848,10 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
     }
 
     if (movesSearched == 0) {
-        if (board.inCheck(board.sideToMove())) {
+        // Only the excluded move was legal: it is singular by definition.
+        if (singularSearch) return alpha;
+
+        if (inCheck) {
             return -MATE_SCORE + plyFromRoot;
         }
         else {
@@ -324,7 +867,7 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
         flag = TranspositionTable::LOWERBOUND;
     }
 
-    tt_.store(key, bestScore, depth, bestMoveInNode, flag);
+    tt_.store(key, scoreToTT(bestScore, plyFromRoot), depth, bestMoveInNode, flag, inCheck ? TranspositionTable::NO_EVAL : staticEval);
 
     return bestScore;
 }
@@ -332,14 +875,59 @@ int Search::negamax(WorkerState& ws, Board& board, int depth, int alpha, int bet
 int Search::quiescence(WorkerState& ws, Board& board, int alpha, int beta, int plyFromRoot) {
     ws.stats.totalNodes++;
     ws.stats.qNodes++;
+    if (plyFromRoot > ws.selDepth) ws.selDepth = plyFromRoot;
+
+    const bool inCheck = board.inCheck(board.sideToMove());
 
-    if (plyFromRoot > 64) {
-        return evaluator_.evaluate(board, board.sideToMove());
+    if (plyFromRoot >= MAX_PLY - 1) {
+        return inCheck ? 0 : staticEvaluation(ws, board);
+    }
+
+    // Every q-search node shares depth 0, so any stored bound is deep enough.
+    const uint64_t key = board.zobristKey();
+    TranspositionTable::TTEntry ent;
+    Move ttMove;
+    const bool ttHit = tt_.probe(key, ent);
+    if (ttHit) ent.value = scoreFromTT(ent.value, plyFromRoot);
+    if (ttHit) {
+        ttMove = ent.bestMove;
+        if (ent.flag == TranspositionTable::EXACT
+            || (ent.flag == TranspositionTable::LOWERBOUND && ent.value >= beta)
+            || (ent.flag == TranspositionTable::UPPERBOUND && ent.value <= alpha)) {
+            return ent.value;
+        }
     }
 
-    int standPat = evaluator_.evaluate(board, board.sideToMove());
-    if (standPat >= beta) return beta;
-    if (standPat > alpha) alpha = standPat;
+    const int oldAlpha = alpha;
+    int standPat = TranspositionTable::NO_EVAL;
+    int ttEval = TranspositionTable::NO_EVAL;
+
+    // In check there is no stand-pat: every evasion is searched instead.
+    if (!inCheck) {
+        // Far outside the window the evaluator may answer with a bound
+        // instead of a score; that is enough to stand pat or to fail low,
+        // but it must not reach the TT as a static eval.
+        bool lazy = false;
+        standPat = (ttHit && ent.staticEval != TranspositionTable::NO_EVAL)
+            ? ent.staticEval
+            : staticEvaluation(ws, board, alpha, beta, lazy);
+        if (!lazy) ttEval = standPat;
+        if (standPat >= beta) {
+            tt_.store(key, scoreToTT(beta, plyFromRoot), 0, Move(), TranspositionTable::LOWERBOUND, ttEval);
+            return beta;
+        }
+        if (standPat > alpha) alpha = standPat;
+
+        // Node-level delta: not even a free queen reaches alpha. Promotions
+        // are the one way to gain more, so keep searching if one is possible.
+        const Color us = board.sideToMove();
+        const uint64_t promotionRank = (us == Color::WHITE) ? 0x00FF000000000000ULL : 0x000000000000FF00ULL;
+        if (standPat + DELTA_PIECE_VALUES[Board::QUEEN] + DELTA_MARGIN <= alpha
+            && !(board.pieceBB(us, Board::PAWN) & promotionRank)) {
+            ws.stats.deltaPrunes++;
+            return alpha;
+        }
+    }
 
     auto allMoves = board.generatePseudoMoves();
 
@@ -347,29 +935,104 @@ int Search::quiescence(WorkerState& ws, Board& board, int alpha, int beta, int p
     captures.reserve(allMoves.size());
 
     for (const auto& m : allMoves) {
-        if (m.isCapture() || m.type == MoveType::PROMOTION) {
+        if (inCheck || m.isCapture() || m.type == MoveType::PROMOTION) {
             captures.push_back(m);
         }
     }
 
-    orderMoves(ws, board, captures, Move());
+    orderMoves(ws, board, captures, ttMove, plyFromRoot);
+
+    Move bestMove;
+    int bestScore = -INF;
+    int legalMoves = 0;
+    int quietEvasions = 0;
 
     for (const auto& move : captures) {
+        const bool quiet = !move.isCapture() && move.type != MoveType::PROMOTION;
+        if (inCheck && quiet && quietEvasions >= QS_MAX_QUIET_EVASIONS && bestScore > -MATE_SCORE + MAX_PLY) {
+            break;
+        }
+
+        // Delta pruning: even winning the victim for free cannot reach alpha.
+        if (!inCheck && move.type != MoveType::PROMOTION) {
+            Board::PieceIndex victim = board.getPieceAt(move.end);
+            if (move.type == MoveType::EN_PASSANT) victim = Board::PAWN;
+            const int gain = (victim < Board::PieceTypeCount) ? DELTA_PIECE_VALUES[victim] : 0;
+            if (standPat + gain + DELTA_MARGIN <= alpha) {
+                ws.stats.deltaPrunes++;
+                continue;
+            }
+        }
+
         if (!board.makeMove(move)) {
             continue;
         }
+        ++legalMoves;
+        if (quiet) ++quietEvasions;
 
         int score = -quiescence(ws, board, -beta, -alpha, plyFromRoot + 1);
 
         board.unmakeMove();
 
-        if (score >= beta) return beta;
-        if (score > alpha) alpha = score;
+        if (score > bestScore) bestScore = score;
+
+        if (score >= beta) {
+            tt_.store(key, scoreToTT(beta, plyFromRoot), 0, move, TranspositionTable::LOWERBOUND, ttEval);
+            return beta;
+        }
+        if (score > alpha) {
+            alpha = score;
+            bestMove = move;
+        }
     }
+
+    if (inCheck && legalMoves == 0) {
+        return -MATE_SCORE + plyFromRoot;
+    }
+
+    tt_.store(key, scoreToTT(alpha, plyFromRoot), 0, bestMove,
+              alpha > oldAlpha ? TranspositionTable::EXACT : TranspositionTable::UPPERBOUND, ttEval);
     return alpha;
 }
 
-void Search::orderMoves(const WorkerState& ws, Board& board, std::vector<Move>& moves, const Move& ttMove) {
+int Search::staticEvaluation(WorkerState& ws, const Board& board) const {
+    const uint64_t key = board.zobristKey();
+    EvalCacheEntry& entry = ws.evalCache[key & (EVAL_CACHE_SIZE - 1)];
+    ws.stats.evalCacheProbes++;
+    if (entry.key == key) {
+        ws.stats.evalCacheHits++;
+        return entry.eval;
+    }
+    entry.key = key;
+    entry.eval = evaluator_.evaluate(board, board.sideToMove());
+    return entry.eval;
+}
+
+int Search::staticEvaluation(WorkerState& ws, const Board& board, int alpha, int beta, bool& lazy) const {
+    const uint64_t key = board.zobristKey();
+    EvalCacheEntry& entry = ws.evalCache[key & (EVAL_CACHE_SIZE - 1)];
+    ws.stats.evalCacheProbes++;
+    lazy = false;
+    if (entry.key == key) {
+        ws.stats.evalCacheHits++;
+        return entry.eval;
+    }
+    ws.stats.lazyEvalProbes++;
+    const int eval = evaluator_.evaluate(board, alpha, beta, &lazy);
+    if (lazy) {
+        ws.stats.lazyEvalSkips++;
+        return eval;
+    }
+    entry.key = key;
+    entry.eval = eval;
+    return eval;
+}
+
+void Search::orderMoves(const WorkerState& ws, Board& board, std::vector<Move>& moves, const Move& ttMove, int plyFromRoot) {
+    const SearchStack& ss = ws.stack[std::min(plyFromRoot, MAX_PLY)];
+    const Move& killer0 = ss.killers[0];
+    const Move& killer1 = ss.killers[1];
+
     std::stable_sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
         int scoreA = 0;
         int scoreB = 0;
@@ -386,9 +1049,13 @@ void Search::orderMoves(const WorkerState& ws, Board& board, std::vector<Move>&
         if (b.type == MoveType::PROMOTION) scoreB += 90000;
 
         if (!a.isCapture()) {
+            if (a == killer0) scoreA += KILLER_SCORE_PRIMARY;
+            else if (a == killer1) scoreA += KILLER_SCORE_SECONDARY;
             scoreA += ws.history[static_cast<int>(board.sideToMove())][a.start][a.end];
         }
         if (!b.isCapture()) {
+            if (b == killer0) scoreB += KILLER_SCORE_PRIMARY;
+            else if (b == killer1) scoreB += KILLER_SCORE_SECONDARY;
             scoreB += ws.history[static_cast<int>(board.sideToMove())][b.start][b.end];
         }
 
@@ -22,6 +22,7 @@ void TimeManager::start(uint64_t millis_left, uint64_t inc, int mtg) {
     hard_alloc_ = std::chrono::milliseconds(hard);
     soft_scale_ = 1.0;
     stable_count_ = 0;
+    fixed_ = false;
 }
 
 void TimeManager::startFixed(uint64_t movetime_ms) {
@@ -35,6 +36,7 @@ void TimeManager::startFixed(uint64_t movetime_ms) {
     hard_alloc_ = std::chrono::milliseconds(budget);
     soft_scale_ = 1.0;
     stable_count_ = 0;
+    fixed_ = true;
 }
 
 bool TimeManager::isSoftTimeUp() const {
@@ -48,7 +50,14 @@ bool TimeManager::isHardTimeUp() const {
     return std::chrono::steady_clock::now() >= start_time_ + hard_alloc_;
 }
 
+uint64_t TimeManager::elapsedMs() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time_).count());
+}
+
 void TimeManager::onIterationComplete(bool best_move_changed) {
+    if (fixed_) return;
+
     if (best_move_changed) {
         stable_count_ = 0;
         soft_scale_ = EXTEND_SCALE;
@@ -1,4 +1,5 @@
 #include "transpositionTable.h"
+#include <algorithm>
 #include <cstring>
 
 TranspositionTable::TranspositionTable(size_t sizeInMB) {
@@ -17,7 +18,7 @@ void TranspositionTable::clear() {
     std::memset(table_.data(), 0xFF, table_.size() * sizeof(TTEntry));
 }
 
-void TranspositionTable::store(uint64_t key, int value, int depth, Move bestMove, int flag) {
+void TranspositionTable::store(uint64_t key, int value, int depth, Move bestMove, int flag, int staticEval) {
     size_t index = key % numEntries_;
     TTEntry& entry = table_[index];
 
@@ -25,12 +26,20 @@ void TranspositionTable::store(uint64_t key, int value, int depth, Move bestMove
     bool isDeeper = (depth >= entry.depth);
 
     if (isEmpty || isDeeper) {
+        const bool sameKey = (entry.key == key);
+        if (staticEval == NO_EVAL && sameKey) {
+            staticEval = entry.staticEval;
+        }
+
         entry.key = key;
+        entry.staticEval = staticEval;
         entry.value = value;
         entry.depth = depth;
         entry.flag = flag;
 
-        if (bestMove.start != bestMove.end) {
+        // Keep an older move only for the same position; another key's move
+        // would be ordered first in a position where it may not be legal.
+        if (bestMove.start != bestMove.end || !sameKey) {
             entry.bestMove = bestMove;
         }
     }
@@ -46,4 +55,15 @@ bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+int TranspositionTable::hashfull() const {
+    const size_t sample = std::min<size_t>(1000, numEntries_);
+    if (sample == 0) return 0;
+
+    size_t used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        if (table_[i].key != UINT64_MAX) ++used;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
@@ -0,0 +1,342 @@
+// Texel tuner for the handcrafted evaluation.
+//
+//   tune <positions> [--threads N] [--iterations N] [--rate R] [--out FILE]
+//
+// Each line of <positions> is a FEN or EPD position followed by the game
+// result from white's side, in any of the usual spellings: [1.0] [0.5] [0.0],
+// 1-0 1/2-1/2 0-1, or an EPD c9 "1-0"; opcode. The evaluation is linear in
+// its parameters (Evaluator::getCoefficients), so every position is reduced
+// to its coefficients once and the optimizer never calls evaluate().
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "endgame.h"
+#include "evaluator.h"
+#include "psqt.h"
+
+namespace {
+
+struct Term {
+    uint16_t index;
+    int16_t value;
+};
+
+// Structure of arrays: the terms of position i are terms[begin[i], begin[i + 1]).
+struct Dataset {
+    std::vector<uint32_t> begin{0};
+    std::vector<Term> terms;
+    std::vector<float> mgWeight;   // phase / MAX_PHASE
+    std::vector<float> result;     // 1, 0.5 or 0 for white
+
+    size_t size() const { return result.size(); }
+};
+
+struct Options {
+    std::string input;
+    std::string output = "tuned_psqt.h";
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int iterations = 2000;
+    double rate = 1.0;
+};
+
+// -1 if the line carries no recognisable result.
+double parseResult(const std::string& text) {
+    static const std::pair<const char*, double> SPELLINGS[] = {
+        {"[1.0]", 1.0}, {"[0.5]", 0.5}, {"[0.0]", 0.0}, {"[1]", 1.0}, {"[0]", 0.0},
+        {"1/2-1/2", 0.5}, {"1-0", 1.0}, {"0-1", 0.0},
+    };
+    for (const auto& [spelling, value] : SPELLINGS) {
+        if (text.find(spelling) != std::string::npos) return value;
+    }
+    return -1.0;
+}
+
+bool loadDataset(const std::string& path, const Evaluator& evaluator, Dataset& data) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    const int half = evaluator.getParameterCount() / 2;
+    std::vector<Evaluator::Coefficient> coefficients;
+    Board board;
+    size_t skipped = 0;
+    size_t specialized = 0;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string placement, side, castling, ep;
+        if (!(fields >> placement >> side >> castling >> ep)
+            || std::count(placement.begin(), placement.end(), '/') != 7) {
+            if (!line.empty()) ++skipped;
+            continue;
+        }
+        std::string rest;
+        std::getline(fields, rest);
+        const double result = parseResult(rest);
+        if (result < 0) {
+            ++skipped;
+            continue;
+        }
+
+        board.loadFEN(placement + " " + side + " " + castling + " " + ep + " 0 1");
+        if (!board.pieceBB(Color::WHITE, Board::KING) || !board.pieceBB(Color::BLACK, Board::KING)) {
+            ++skipped;
+            continue;
+        }
+        // Scored by Endgame::probe, not by the parameters being tuned.
+        int endgame;
+        if (Endgame::probe(board, endgame)) {
+            ++specialized;
+            continue;
+        }
+
+        evaluator.getCoefficients(board, coefficients);
+        for (const auto& c : coefficients) {
+            if (c.index >= half) continue;
+            data.terms.push_back({static_cast<uint16_t>(c.index), static_cast<int16_t>(c.value)});
+        }
+        data.begin.push_back(static_cast<uint32_t>(data.terms.size()));
+        data.mgWeight.push_back(static_cast<float>(Evaluator::gamePhase(board)) / Psqt::MAX_PHASE);
+        data.result.push_back(static_cast<float>(result));
+    }
+
+    if (skipped) std::cout << "skipped " << skipped << " unreadable lines\n";
+    if (specialized) std::cout << "skipped " << specialized << " specialized endgame positions\n";
+    return data.size() > 0;
+}
+
+// Runs fn(begin, end, thread) over [0, n) split evenly across threads.
+void parallelFor(int threads, size_t n, const std::function<void(size_t, size_t, int)>& fn) {
+    std::vector<std::thread> pool;
+    const size_t chunk = (n + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        const size_t lo = std::min(n, t * chunk);
+        const size_t hi = std::min(n, lo + chunk);
+        pool.emplace_back(fn, lo, hi, t);
+    }
+    for (auto& th : pool) th.join();
+}
+
+double evaluate(const Dataset& data, size_t i, const std::vector<double>& params, int half) {
+    double mg = 0.0;
+    double eg = 0.0;
+    for (uint32_t k = data.begin[i]; k < data.begin[i + 1]; ++k) {
+        const Term& t = data.terms[k];
+        mg += t.value * params[t.index];
+        eg += t.value * params[t.index + half];
+    }
+    const double w = data.mgWeight[i];
+    return mg * w + eg * (1.0 - w);
+}
+
+double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+}
+
+double meanError(const Dataset& data, const std::vector<double>& params, int half, double k, int threads) {
+    std::vector<double> partial(threads, 0.0);
+    parallelFor(threads, data.size(), [&](size_t lo, size_t hi, int t) {
+        double sum = 0.0;
+        for (size_t i = lo; i < hi; ++i) {
+            const double diff = data.result[i] - sigmoid(k, evaluate(data, i, params, half));
+            sum += diff * diff;
+        }
+        partial[t] = sum;
+    });
+    double total = 0.0;
+    for (double p : partial) total += p;
+    return total / static_cast<double>(data.size());
+}
+
+// The scaling K that best maps the current evaluation onto the results,
+// narrowed one decimal place at a time.
+double findK(const Dataset& data, const std::vector<double>& params, int half, int threads) {
+    double best = 1.0;
+    double bestError = meanError(data, params, half, best, threads);
+    for (double step = 1.0; step >= 0.001; step /= 10.0) {
+        const double centre = best;
+        for (int s = -10; s <= 10; ++s) {
+            const double k = centre + s * step;
+            if (k <= 0.0 || s == 0) continue;
+            const double error = meanError(data, params, half, k, threads);
+            if (error < bestError) {
+                bestError = error;
+                best = k;
+            }
+        }
+    }
+    return best;
+}
+
+void gradient(const Dataset& data, const std::vector<double>& params, int half, double k, int threads,
+              std::vector<double>& grad) {
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(params.size(), 0.0));
+    parallelFor(threads, data.size(), [&](size_t lo, size_t hi, int t) {
+        std::vector<double>& g = partial[t];
+        for (size_t i = lo; i < hi; ++i) {
+            const double s = sigmoid(k, evaluate(data, i, params, half));
+            // d(error)/d(eval), up to the constant factor 2 K ln(10) / 400.
+            const double d = (s - data.result[i]) * s * (1.0 - s);
+            const double w = data.mgWeight[i];
+            for (uint32_t j = data.begin[i]; j < data.begin[i + 1]; ++j) {
+                const Term& term = data.terms[j];
+                g[term.index] += d * term.value * w;
+                g[term.index + half] += d * term.value * (1.0 - w);
+            }
+        }
+    });
+    std::fill(grad.begin(), grad.end(), 0.0);
+    for (const auto& g : partial) {
+        for (size_t i = 0; i < grad.size(); ++i) grad[i] += g[i];
+    }
+}
+
+void writeHeader(const std::string& path, const std::vector<double>& params, int half,
+                 const Options& options, size_t positions, double k, double error) {
+    static const char* PIECE_NAMES[Evaluator::PST_COUNT] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
+    static const char* PHASE_NAMES[2] = {"midgame", "endgame"};
+
+    auto rounded = [&](int index) {
+        return static_cast<int>(std::clamp<long>(std::lround(params[index]), INT16_MIN, INT16_MAX));
+    };
+
+    std::ofstream out(path);
+    out << "// Generated by tune from " << options.input << ": " << positions << " positions, K = " << k
+        << ", error " << std::setprecision(6) << error << ".\n"
+        << "// PIECE_VALUE and PIECE_SQUARE match Psqt::Tables (a1 = 0, white's side);\n"
+        << "// ACTIVITY follows Evaluator's parameter order.\n"
+        << "#pragma once\n\n#include <cstdint>\n\nnamespace TunedPsqt {\n\n";
+
+    out << "constexpr int16_t PIECE_VALUE[2][" << Evaluator::PST_COUNT << "] = {\n";
+    for (int phase = 0; phase < 2; ++phase) {
+        out << "    {";
+        for (int piece = 0; piece < Evaluator::PST_COUNT; ++piece) {
+            out << (piece ? ", " : "") << rounded(phase * half + piece);
+        }
+        out << "},   // " << PHASE_NAMES[phase] << "\n";
+    }
+    out << "};\n\n";
+
+    out << "constexpr int16_t PIECE_SQUARE[2][" << Evaluator::PST_COUNT << "][64] = {\n";
+    for (int phase = 0; phase < 2; ++phase) {
+        out << "    {   // " << PHASE_NAMES[phase] << "\n";
+        for (int piece = 0; piece < Evaluator::PST_COUNT; ++piece) {
+            out << "        {   // " << PIECE_NAMES[piece] << "\n";
+            for (int rank = 0; rank < 8; ++rank) {
+                out << "           ";
+                for (int file = 0; file < 8; ++file) {
+                    out << " " << std::setw(4) << rounded(phase * half + Evaluator::PST_COUNT + piece * 64 + rank * 8 + file)
+                        << ",";
+                }
+                out << "\n";
+            }
+            out << "        },\n";
+        }
+        out << "    },\n";
+    }
+    out << "};\n\n";
+
+    // Everything after the tables: the evaluator's activity weights, in the
+    // order of its parameter block.
+    const int pstParams = Evaluator::PST_COUNT + Evaluator::PST_COUNT * 64;
+    out << "constexpr int16_t ACTIVITY[2][" << half - pstParams << "] = {\n";
+    for (int phase = 0; phase < 2; ++phase) {
+        out << "    {   // " << PHASE_NAMES[phase];
+        for (int i = pstParams; i < half; ++i) {
+            if ((i - pstParams) % 14 == 0) out << "\n       ";
+            out << " " << rounded(phase * half + i) << ",";
+        }
+        out << "\n    },\n";
+    }
+    out << "};\n\n} // namespace TunedPsqt\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--threads" && hasValue) options.threads = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--iterations" && hasValue) options.iterations = std::stoi(argv[++i]);
+            else if (arg == "--rate" && hasValue) options.rate = std::stod(argv[++i]);
+            else if (arg == "--out" && hasValue) options.output = argv[++i];
+            else if (options.input.empty() && arg.rfind("--", 0) != 0) options.input = arg;
+            else return false;
+        } catch (...) {
+            return false;
+        }
+    }
+    return !options.input.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: tune <positions> [--threads N] [--iterations N] [--rate R] [--out FILE]\n";
+        return 1;
+    }
+
+    Evaluator evaluator;
+    const int count = evaluator.getParameterCount();
+    const int half = count / 2;
+
+    Dataset data;
+    if (!loadDataset(options.input, evaluator, data)) {
+        std::cerr << "no positions loaded from " << options.input << "\n";
+        return 1;
+    }
+    std::cout << "loaded " << data.size() << " positions (" << data.terms.size() << " terms), "
+              << options.threads << " threads\n";
+
+    std::vector<double> params(count);
+    for (int i = 0; i < count; ++i) params[i] = evaluator.getParameter(i);
+
+    const double k = findK(data, params, half, options.threads);
+    const double startError = meanError(data, params, half, k, options.threads);
+    std::cout << "K = " << k << ", error " << std::setprecision(6) << startError << "\n";
+
+    // Adam: per-parameter step sizes cope with parameters that appear in a
+    // handful of positions next to ones that appear in every position.
+    constexpr double BETA1 = 0.9;
+    constexpr double BETA2 = 0.999;
+    constexpr double EPSILON = 1e-8;
+    std::vector<double> grad(count), m(count, 0.0), v(count, 0.0);
+
+    const auto start = std::chrono::steady_clock::now();
+    double error = startError;
+    for (int iteration = 1; iteration <= options.iterations; ++iteration) {
+        gradient(data, params, half, k, options.threads, grad);
+        for (int i = 0; i < count; ++i) {
+            m[i] = BETA1 * m[i] + (1.0 - BETA1) * grad[i];
+            v[i] = BETA2 * v[i] + (1.0 - BETA2) * grad[i] * grad[i];
+            const double mHat = m[i] / (1.0 - std::pow(BETA1, iteration));
+            const double vHat = v[i] / (1.0 - std::pow(BETA2, iteration));
+            params[i] -= options.rate * mHat / (std::sqrt(vHat) + EPSILON);
+        }
+
+        if (iteration % 100 == 0 || iteration == options.iterations) {
+            error = meanError(data, params, half, k, options.threads);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "iteration " << iteration << "  error " << error << "  (" << std::setprecision(1)
+                      << std::fixed << seconds << "s)" << std::defaultfloat << std::setprecision(6) << std::endl;
+            writeHeader(options.output, params, half, options, data.size(), k, error);
+        }
+    }
+
+    std::cout << "wrote " << options.output << " (error " << startError << " -> " << error << ")\n";
+    return 0;
+}
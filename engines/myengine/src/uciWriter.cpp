@@ -0,0 +1,51 @@
+#include "uciWriter.h"
+
+UciWriter::UciWriter(std::ostream& out)
+    : out_(out), thread_(&UciWriter::run, this) {}
+
+UciWriter::~UciWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exiting_ = true;
+    }
+    pendingCv_.notify_all();
+    thread_.join();
+}
+
+void UciWriter::send(std::string line) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(line));
+    }
+    pendingCv_.notify_one();
+}
+
+void UciWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drainedCv_.wait(lock, [&] { return queue_.empty() && !writing_; });
+}
+
+void UciWriter::run() {
+    std::deque<std::string> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            writing_ = false;
+            drainedCv_.notify_all();
+
+            pendingCv_.wait(lock, [&] { return exiting_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // exiting with nothing left to write
+
+            batch.swap(queue_);
+            writing_ = true;
+        }
+
+        // Write outside the lock: a blocked pipe only holds up this thread.
+        for (const auto& line : batch) {
+            out_ << line << '\n';
+        }
+        out_.flush();
+        batch.clear();
+    }
+}
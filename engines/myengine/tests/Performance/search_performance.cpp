@@ -360,6 +360,61 @@ static void bench_summary() {
 	}
 }
 
+static void bench_forward_pruning() {
+	std::printf("\n========== 10. FORWARD PRUNING ==========\n");
+	std::printf("  Static-eval prunes per 1000 non-Q nodes.\n");
+	std::printf("  RFP/Razor prune whole nodes; Fut/LMP skip individual quiet moves.\n\n");
+
+	std::printf("  %-12s  %-5s  %-12s  %-8s  %-8s  %-8s  %-8s\n",
+	            "Position", "D", "Nodes", "RFP", "Razor", "Fut", "LMP");
+	std::printf("  %s\n", std::string(70, '-').c_str());
+
+	for (int p = 0; p < N_POSITIONS; ++p) {
+		const Pos& pos = POSITIONS[p];
+		Result r = run(pos.fen, SEARCH_DEPTH + 2);
+		long long nonQ = std::max(1LL, r.stats.totalNodes - r.stats.qNodes);
+		auto perMille = [&](long long n) { return 1000.0 * (double)n / (double)nonQ; };
+		std::printf("  %-12s  %-5d  %-12lld  %-8.1f  %-8.1f  %-8.1f  %-8.1f\n",
+		            pos.label, SEARCH_DEPTH + 2, r.stats.totalNodes,
+		            perMille(r.stats.rfpPrunes), perMille(r.stats.razorPrunes),
+		            perMille(r.stats.futilityPrunes), perMille(r.stats.lmpPrunes));
+	}
+	std::printf("\n  (All zero means the pruning conditions never trigger — check margins.)\n");
+}
+
+static void bench_root_split() {
+	std::printf("\n========== 11. ROOT SPLITTING ==========\n");
+	std::printf("  Wall time (ms) at shallow depth: 1 thread vs 4-thread Lazy SMP vs 4-thread root split.\n\n");
+
+	std::printf("  %-12s  %-5s  %-10s  %-10s  %-10s  %-8s\n",
+	            "Position", "D", "1T", "LazySMP", "Split", "Speedup");
+	std::printf("  %s\n", std::string(64, '-').c_str());
+
+	auto timeSearch = [](const char* fen, int depth, int threads, bool split) {
+		Board board;
+		board.loadFEN(fen);
+		TranspositionTable tt(16);
+		Evaluator ev;
+		Search search(ev, tt);
+		search.setThreadCount(threads);
+		search.setRootSplit(split);
+		auto t0 = Clock::now();
+		search.findBestMove(board, depth, 0, 0);
+		return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count() / 1000.0;
+	};
+
+	for (int p = 0; p < N_POSITIONS; ++p) {
+		const Pos& pos = POSITIONS[p];
+		for (int d : {6, 8}) {
+			double single = timeSearch(pos.fen, d, 1, false);
+			double lazy = timeSearch(pos.fen, d, 4, false);
+			double split = timeSearch(pos.fen, d, 4, true);
+			std::printf("  %-12s  %-5d  %-10.1f  %-10.1f  %-10.1f  %-8.2f\n",
+			            pos.label, d, single, lazy, split, split > 0 ? single / split : 0.0);
+		}
+	}
+}
+
 int main() {
 	auto now = std::chrono::system_clock::now();
 	std::time_t now_t = std::chrono::system_clock::to_time_t(now);
@@ -400,6 +455,8 @@ int main() {
 	bench_warm_tt();
 	bench_time_control();
 	bench_summary();
+	bench_forward_pruning();
+	bench_root_split();
 
 	std::printf("\n========================================\n");
 	std::printf("Done.\n");
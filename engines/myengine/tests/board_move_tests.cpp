@@ -316,9 +316,78 @@ static void test_draw_and_material_detectors() {
             b.unmakeMove(); b.unmakeMove();
         }
     }
+    {
+        Board b; b.loadFEN("8/8/8/8/8/8/P7/K6k w - - 0 1");
+        assert(!b.isInsufficientMaterial());
+    }
     std::cout << "  ok insufficient material\n\n";
 }
 
+static void test_repetition_detection() {
+    std::cout << "--- test_repetition_detection ---\n";
+    auto play = [](Board& b, const char* uci) {
+        const Move parsed = Move::fromUCI(uci);
+        for (const Move& m : b.generateLegalMoves()) {
+            if (m.start == parsed.start && m.end == parsed.end && m.promo == parsed.promo) {
+                b.makeMove(m);
+                return;
+            }
+        }
+        std::cerr << "illegal test move " << uci << "\n";
+        assert(false);
+    };
+    {
+        // Knight shuffle after Kd1: the position after Kd1 has now occurred twice.
+        Board b; b.loadFEN("6n1/4k3/8/8/8/8/8/1N2K3 w - - 0 1");
+        for (const char* m : {"e1d1", "g8f6", "b1c3", "f6g8", "c3b1"}) play(b, m);
+        assert(!b.isThreefoldRepetition());
+        assert(b.isRepetition(5) && "a repeat after the root is a draw in search");
+        assert(!b.isRepetition(4) && "a single repeat of the root or earlier is not");
+        assert(!b.isRepetition(0));
+
+        for (const char* m : {"g8f6", "b1c3", "f6g8", "c3b1"}) play(b, m);
+        assert(b.isThreefoldRepetition());
+        assert(b.isRepetition(0));
+    }
+    {
+        // An irreversible move in between breaks the cycle.
+        Board b; b.loadFEN("6n1/p3k3/8/8/8/8/8/1N2K3 b - - 0 1");
+        for (const char* m : {"g8f6", "b1c3", "f6g8", "c3b1", "a7a6"}) play(b, m);
+        for (const char* m : {"b1c3", "g8f6", "c3b1", "f6g8"}) play(b, m);
+        assert(b.isRepetition(5));
+        for (int i = 0; i < 4; ++i) b.unmakeMove();
+        assert(!b.isRepetition(9) && "cycle before a7a6 cannot repeat");
+    }
+    {
+        Board b; b.loadFEN("6n1/4k3/8/8/8/8/8/1N2K3 w - - 99 80");
+        assert(!b.isFiftyMoveDraw());
+        play(b, "b1c3");
+        assert(b.isFiftyMoveDraw());
+    }
+    std::cout << "  ok repetition and fifty-move\n\n";
+}
+
+static void test_non_pawn_material() {
+    std::cout << "--- test_non_pawn_material ---\n";
+    {
+        // Kings are not non-pawn material: pure pawn endings must report none.
+        Board b; b.loadFEN("8/2p5/3p4/KP6/5p1k/8/4P1P1/8 w - - 0 1");
+        assert(!b.hasNonPawnMaterial(Color::WHITE));
+        assert(!b.hasNonPawnMaterial(Color::BLACK));
+    }
+    {
+        Board b; b.loadFEN("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+        assert(b.hasNonPawnMaterial(Color::WHITE));
+        assert(b.hasNonPawnMaterial(Color::BLACK));
+    }
+    {
+        Board b; b.loadFEN("k7/8/8/8/8/8/8/KN6 w - - 0 1");
+        assert(b.hasNonPawnMaterial(Color::WHITE));
+        assert(!b.hasNonPawnMaterial(Color::BLACK));
+    }
+    std::cout << "  ok non-pawn material\n\n";
+}
+
 static void test_no_bogus_moves_from_scholar_fen() {
     std::cout << "--- test_no_bogus_moves_from_scholar_fen ---\n";
     const string scholar = "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 2 3";
@@ -346,6 +415,8 @@ int main() {
 
     test_make_unmake_integrity();
     test_draw_and_material_detectors();
+    test_non_pawn_material();
+    test_repetition_detection();
 
     test_no_bogus_moves_from_scholar_fen();
 
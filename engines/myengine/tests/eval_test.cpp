@@ -4,15 +4,24 @@
  * Full evaluator test suite.  Sections:
  *
  *  1. Material values    – each piece type has the expected raw value
- *  2. PST bonuses        – piece-square tables produce expected score deltas
+ *  2. PST bonuses        – piece-square tables and piece activity produce expected score deltas
  *  3. Evaluator properties – perspective consistency, symmetry, boundedness
  *  4. Terminal detection – checkmate and stalemate return correct scores
+ *  5. Network evaluation – file loading and incremental accumulators
+ *  6. Endgames           – specialized evaluators chosen by material
  */
 
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "endgame.h"
 #include "evaluator.h"
+#include "nnue.h"
+#include "psqt.h"
 #include "board.h"
 
 
@@ -53,6 +62,14 @@ static void expect_eq(int a, int b, const char* label) {
     std::cout << "  PASS " << label << " (" << a << " == " << b << ")\n";
 }
 
+// Unlike assert, stays on in release (NDEBUG) builds, so the condition may do work.
+static void expect_true(bool cond, const char* label) {
+    if (!cond) {
+        std::cerr << "FAIL " << label << "\n";
+        std::exit(1);
+    }
+}
+
 
 // ===========================================================================
 // SECTION 1 – Material values
@@ -220,6 +237,50 @@ static void test_pst_queen_center_vs_rim() {
     std::cout << "  PASS queen center >= queen rim\n\n";
 }
 
+// Kings shelter in the middlegame and centralise in the endgame.
+static void test_pst_king_tapers_with_phase() {
+    std::cout << "--- test_pst_king_tapers_with_phase ---\n";
+
+    int mgCastled = eval("r1bq1rk1/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQ1RK1 w - - 0 1");
+    int mgCentral = eval("r1bq1rk1/pppp1ppp/2n2n2/2b1p3/2B1P3/2N1KN2/PPPP1PPP/R1BQ1R2 w - - 0 1");
+    expect_gt(mgCastled, mgCentral, "midgame: castled king (g1) > exposed king (e3)");
+
+    int egCorner  = eval("4k3/8/8/8/8/8/4P3/7K w - - 0 1");
+    int egCentral = eval("4k3/8/8/8/3K4/8/4P3/8 w - - 0 1");
+    expect_gt(egCentral, egCorner, "endgame: central king (d4) > corner king (h1)");
+
+    Board full("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    Board bare("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+    expect_eq(Evaluator::gamePhase(full), Psqt::MAX_PHASE, "start position is pure midgame");
+    expect_eq(Evaluator::gamePhase(bare), 0, "pawn ending is pure endgame");
+
+    const Psqt::Score packed = Psqt::makeScore(-37, 125) + Psqt::makeScore(12, -300);
+    expect_eq(Psqt::mgValue(packed), -25, "packed midgame half");
+    expect_eq(Psqt::egValue(packed), -175, "packed endgame half");
+    std::cout << "\n";
+}
+
+// Same squares and material; only the b2 pawn blocking the bishop differs
+// (b2 and g2 have the same pawn PST value).
+static void test_activity_open_bishop_beats_blocked() {
+    std::cout << "--- test_activity_open_bishop_beats_blocked ---\n";
+
+    int blocked = eval("4k3/8/8/8/8/8/1P6/B3K3 w - - 0 1");
+    int open    = eval("4k3/8/8/8/8/8/6P1/B3K3 w - - 0 1");
+    expect_gt(open, blocked, "open long diagonal > bishop behind its own pawn");
+    std::cout << "\n";
+}
+
+static void test_activity_pawn_fork_is_a_threat() {
+    std::cout << "--- test_activity_pawn_fork_is_a_threat ---\n";
+
+    // d4 attacks both knights; with the knights on b5/f5 it attacks nothing.
+    int fork   = eval("4k3/8/8/2n1n3/3P4/8/8/4K3 w - - 0 1");
+    int noFork = eval("4k3/8/8/1n3n2/3P4/8/8/4K3 w - - 0 1");
+    expect_gt(fork, noFork + 20, "pawn forking two knights");
+    std::cout << "\n";
+}
+
 
 // ===========================================================================
 // SECTION 3 – Evaluator properties
@@ -314,6 +375,168 @@ static void test_property_equal_material_near_zero() {
     std::cout << "\n";
 }
 
+// The running material+PST sum must match a fresh load after any move
+// sequence: captures, castling, en passant and promotions included.
+static int check_incremental(Board& b, int depth) {
+    int checked = 1;
+    Board fresh(b.toFEN());
+    if (b.psqtScore() != fresh.psqtScore() || b.phaseMaterial() != fresh.phaseMaterial()) {
+        std::cerr << "FAIL incremental psqt at " << b.toFEN() << ": "
+                  << b.psqtScore() << " != " << fresh.psqtScore() << "\n";
+        std::exit(1);
+    }
+    if (depth == 0) return checked;
+
+    for (const Move& m : b.generateLegalMoves()) {
+        const int before = b.psqtScore();
+        b.makeMove(m);
+        checked += check_incremental(b, depth - 1);
+        b.unmakeMove();
+        if (b.psqtScore() != before) {
+            std::cerr << "FAIL unmake " << m.toString() << " did not restore the psqt sum\n";
+            std::exit(1);
+        }
+    }
+    return checked;
+}
+
+static void test_property_incremental_matches_scratch() {
+    std::cout << "--- test_property_incremental_matches_scratch ---\n";
+
+    const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+    };
+    for (auto fen : fens) {
+        Board b(fen);
+        int nodes = check_incremental(b, 3);
+        std::cout << "  " << nodes << " positions match  [" << fen << "]\n";
+    }
+    std::cout << "  PASS incremental psqt\n\n";
+}
+
+static void collect_positions(Board& b, int depth, std::vector<Board>& out) {
+    out.push_back(b);
+    if (depth == 0) return;
+    for (const Move& m : b.generateLegalMoves()) {
+        b.makeMove(m);
+        collect_positions(b, depth - 1, out);
+        b.unmakeMove();
+    }
+}
+
+static void test_property_batch_matches_scalar() {
+    std::cout << "--- test_property_batch_matches_scalar ---\n";
+
+    // Enough positions to span several blocks and end on a partial one.
+    std::vector<Board> boards;
+    Board kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Board endgame("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    collect_positions(kiwipete, 2, boards);
+    collect_positions(endgame, 2, boards);
+
+    std::vector<int> scores(boards.size());
+    g_ev.evaluateBatch(boards.data(), boards.size(), scores.data());
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+        if (scores[i] != g_ev.evaluate(boards[i], Color::WHITE)) {
+            std::cerr << "FAIL batch eval at " << boards[i].toFEN() << ": " << scores[i]
+                      << " != " << g_ev.evaluate(boards[i], Color::WHITE) << "\n";
+            std::exit(1);
+        }
+    }
+    std::cout << "  PASS " << boards.size() << " batched scores match evaluate()\n\n";
+}
+
+// The tuner relies on evaluate() being a blend of two dot products over
+// getCoefficients(); check that on the same positions.
+static void test_property_coefficients_reproduce_eval() {
+    std::cout << "--- test_property_coefficients_reproduce_eval ---\n";
+
+    std::vector<Board> boards;
+    Board kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    collect_positions(kiwipete, 2, boards);
+
+    const int half = g_ev.getParameterCount() / 2;
+    std::vector<Evaluator::Coefficient> coefficients;
+    for (const Board& b : boards) {
+        g_ev.getCoefficients(b, coefficients);
+        int mg = 0, eg = 0;
+        for (const auto& c : coefficients) {
+            mg += c.value * g_ev.getParameter(c.index);
+            eg += c.value * g_ev.getParameter(c.index + half);
+        }
+        const int phase = Evaluator::gamePhase(b);
+        const int blended = (mg * phase + eg * (Psqt::MAX_PHASE - phase)) / Psqt::MAX_PHASE;
+        if (blended != g_ev.evaluate(b, Color::WHITE)) {
+            std::cerr << "FAIL coefficients at " << b.toFEN() << ": " << blended
+                      << " != " << g_ev.evaluate(b, Color::WHITE) << "\n";
+            std::exit(1);
+        }
+    }
+    std::cout << "  PASS " << boards.size() << " positions reproduced from coefficients\n\n";
+}
+
+// Parameters are stored as int16_t; a value that does not fit must be
+// rejected, not truncated.
+static void test_set_parameter_rejects_out_of_range() {
+    std::cout << "--- test_set_parameter_rejects_out_of_range ---\n";
+
+    const int knightValue = g_ev.getParameter(1);
+    const int lastIndex = g_ev.getParameterCount() - 1;
+    const int lastValue = g_ev.getParameter(lastIndex);
+    expect_true(!g_ev.setParameter(1, 40000), "piece value 40000 rejected");
+    expect_true(!g_ev.setParameter(lastIndex, -40000), "activity weight -40000 rejected");
+    expect_true(!g_ev.setParameter(g_ev.getParameterCount(), 0), "index past the end rejected");
+    expect_eq(g_ev.getParameter(1), knightValue, "knight value unchanged");
+    expect_eq(g_ev.getParameter(lastIndex), lastValue, "activity weight unchanged");
+
+    expect_true(g_ev.setParameter(1, knightValue + 10), "in-range value accepted");
+    expect_eq(g_ev.getParameter(1), knightValue + 10, "knight value updated");
+    expect_true(g_ev.setParameter(1, knightValue), "original value restored");
+    std::cout << "\n";
+}
+
+// A lazy answer must be a sound bound for the window it was asked about,
+// and anything else must be the full score.
+static void test_property_lazy_eval_bounds() {
+    std::cout << "--- test_property_lazy_eval_bounds ---\n";
+
+    std::vector<Board> boards;
+    Board kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Board endgame("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    collect_positions(kiwipete, 2, boards);
+    collect_positions(endgame, 2, boards);
+
+    int skipped = 0, checked = 0;
+    for (const Board& b : boards) {
+        const int full = g_ev.evaluate(b, b.sideToMove());
+        for (int alpha = -1200; alpha <= 1200; alpha += 200) {
+            const int beta = alpha + 50;
+            bool lazy = true;
+            const int score = g_ev.evaluate(b, alpha, beta, &lazy);
+            ++checked;
+            if (!lazy) {
+                if (score != full) {
+                    std::cerr << "FAIL non-lazy score " << score << " != " << full << " at " << b.toFEN() << "\n";
+                    std::exit(1);
+                }
+                continue;
+            }
+            ++skipped;
+            const bool sound = (score >= beta && full >= beta) || (score <= alpha && full <= alpha);
+            if (!sound) {
+                std::cerr << "FAIL lazy bound " << score << " for window (" << alpha << ", " << beta
+                          << "), full score " << full << " at " << b.toFEN() << "\n";
+                std::exit(1);
+            }
+        }
+    }
+    expect_gt(skipped, 0, "some windows are answered lazily");
+    expect_gt(checked - skipped, 0, "some windows need the full score");
+    std::cout << "  PASS " << skipped << " of " << checked << " windows answered lazily\n\n";
+}
+
 
 // ===========================================================================
 // SECTION 4 – Terminal detection
@@ -360,7 +583,169 @@ static void test_terminal_non_terminal_returns_zero() {
 // main
 // ===========================================================================
 
+// ===========================================================================
+// SECTION 5 – Network evaluation
+// ===========================================================================
+
+static const char* TEST_NET = "eval_test_net.bin";
+
+// A random network in the EvalFile format, with weights small enough that
+// no intermediate sum can overflow.
+static void write_random_net(const char* path, std::size_t truncateTo = 0) {
+    std::string bytes = "MYNN";
+    auto put32 = [&](uint32_t v) { for (int i = 0; i < 4; ++i) bytes.push_back(static_cast<char>(v >> (8 * i))); };
+    auto put16 = [&](int v) { bytes.push_back(static_cast<char>(v & 0xFF)); bytes.push_back(static_cast<char>((v >> 8) & 0xFF)); };
+    put32(1);
+    put32(Nnue::HIDDEN);
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> feature(-40, 40), bias(-100, 100), output(-60, 60);
+    for (int i = 0; i < Nnue::INPUTS * Nnue::HIDDEN; ++i) put16(feature(rng));
+    for (int i = 0; i < Nnue::HIDDEN; ++i) put16(bias(rng));
+    for (int i = 0; i < 2 * Nnue::HIDDEN; ++i) put16(output(rng));
+    put32(static_cast<uint32_t>(-500));
+
+    if (truncateTo) bytes.resize(truncateTo);
+    std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+static void test_nnue_rejects_bad_files() {
+    std::cout << "--- test_nnue_rejects_bad_files ---\n";
+
+    const bool missingLoaded = Nnue::load("does_not_exist.nnue");
+    expect_true(!missingLoaded, "missing file rejected");
+    write_random_net(TEST_NET, 1000);
+    const bool truncatedLoaded = Nnue::load(TEST_NET);
+    expect_true(!truncatedLoaded, "truncated file rejected");
+    expect_true(!Nnue::isLoaded(), "no net left loaded");
+    std::cout << "  PASS missing and truncated files rejected\n\n";
+}
+
+// Every accumulator reached by makeMove must match one built from scratch,
+// and the vector kernels must agree with the scalar reference.
+static int check_accumulator(Board& b, int depth) {
+    int checked = 1;
+    Board fresh(b.toFEN());
+    const int stm = static_cast<int>(b.sideToMove());
+    const int incremental = Nnue::evaluate(b.accumulator(), stm);
+    if (incremental != Nnue::evaluate(fresh.accumulator(), stm)
+        || incremental != Nnue::evaluateScalar(b.accumulator(), stm)) {
+        std::cerr << "FAIL accumulator at " << b.toFEN() << ": " << incremental << " vs "
+                  << Nnue::evaluate(fresh.accumulator(), stm) << " / "
+                  << Nnue::evaluateScalar(b.accumulator(), stm) << "\n";
+        std::exit(1);
+    }
+    if (depth == 0) return checked;
+
+    for (const Move& m : b.generateLegalMoves()) {
+        b.makeMove(m);
+        checked += check_accumulator(b, depth - 1);
+        b.unmakeMove();
+    }
+    return checked;
+}
+
+static void test_nnue_incremental_matches_refresh() {
+    std::cout << "--- test_nnue_incremental_matches_refresh ---\n";
+
+    const int pstScore = eval("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    write_random_net(TEST_NET);
+    const bool loaded = Nnue::load(TEST_NET);
+    expect_true(loaded, "test net loads");
+
+    const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+    };
+    for (auto fen : fens) {
+        Board b(fen);
+        int nodes = check_accumulator(b, 2);
+        std::cout << "  " << nodes << " positions match  [" << fen << "]\n";
+
+        b.makeNullMove();
+        Board flipped(b.toFEN());
+        expect_eq(g_ev.evaluate(b, b.sideToMove()), g_ev.evaluate(flipped, flipped.sideToMove()),
+                  "null move keeps the accumulator");
+        b.unmakeNullMove();
+        expect_eq(g_ev.evaluate(b, Color::WHITE), -g_ev.evaluate(b, Color::BLACK), "network eval negates");
+    }
+
+    Nnue::unload();
+    expect_eq(eval(fens[0]), pstScore, "unloading restores the PST eval");
+    std::remove(TEST_NET);
+    std::cout << "\n";
+}
+
+// ===========================================================================
+// SECTION 6 – Endgames
+// ===========================================================================
+
+static void test_endgame_kpk_bitbase() {
+    std::cout << "--- test_endgame_kpk_bitbase ---\n";
+
+    // Textbook cases, including who has the opposition.
+    expect_gt(eval("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1"), Endgame::KNOWN_WIN, "king on the sixth wins");
+    expect_gt(eval("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"), Endgame::KNOWN_WIN, "... whoever moves");
+    expect_eq(eval("8/4k3/8/4K3/4P3/8/8/8 w - - 0 1"), 0, "opposition to the defender draws");
+    expect_gt(eval("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1"), Endgame::KNOWN_WIN, "opposition to the attacker wins");
+    expect_eq(eval("8/8/8/8/8/4k3/4P3/4K3 w - - 0 1"), 0, "blockaded pawn draws");
+    expect_eq(eval("k7/8/8/8/8/8/P7/K7 w - - 0 1"), 0, "rook pawn with the king in the corner draws");
+
+    // Black pawn: the table is probed with colours swapped.
+    expect_eq(eval("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1"), -eval("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"),
+              "black pawn mirrors white");
+    // Files e-h are mirrored onto a-d.
+    expect_eq(Endgame::kpkWin(44, 36, 60, true), Endgame::kpkWin(43, 35, 59, true), "e-file mirrors d-file");
+    std::cout << "\n";
+}
+
+static void test_endgame_mop_up_drives_king_to_edge() {
+    std::cout << "--- test_endgame_mop_up_drives_king_to_edge ---\n";
+
+    // Same king distance; only the defending king's square differs.
+    int edge   = eval("8/8/8/8/7k/8/8/1R2K3 w - - 0 1");
+    int centre = eval("8/8/8/8/4k3/8/8/1R2K3 w - - 0 1");
+    expect_gt(centre, Endgame::KNOWN_WIN, "KRK is a known win");
+    expect_gt(edge, centre, "defending king on the edge");
+
+    // Closer attacking king, same defending king.
+    int near = eval("8/8/8/8/7k/8/5K2/1R6 w - - 0 1");
+    expect_gt(near, edge, "attacking king closer");
+    std::cout << "\n";
+}
+
+static void test_endgame_kbnk_prefers_bishop_corner() {
+    std::cout << "--- test_endgame_kbnk_prefers_bishop_corner ---\n";
+
+    // Dark-squared bishop on c1: mate is possible in a1 and h8 only.
+    int right = eval("7k/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+    int wrong = eval("k7/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+    expect_gt(wrong, Endgame::KNOWN_WIN, "KBNK is a known win");
+    expect_gt(right, wrong, "king in the bishop's corner");
+    std::cout << "\n";
+}
+
+static void test_endgame_draws() {
+    std::cout << "--- test_endgame_draws ---\n";
+
+    expect_eq(eval("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1"), 0, "KNNK");
+    expect_eq(eval("4k3/8/8/8/8/8/8/2B1K3 w - - 0 1"), 0, "KBK");
+    expect_eq(eval("4k3/8/8/8/8/4B3/8/2B1K3 w - - 0 1"), 0, "KBBK, same-coloured bishops");
+
+    // Not covered: the general evaluation still applies.
+    Board kpp("4k3/8/8/8/8/8/3PP3/4K3 w - - 0 1");
+    int score;
+    expect_eq(Endgame::probe(kpp, score), false, "KPPK is left to the general evaluation");
+    std::cout << "\n";
+}
+
+
 int main() {
+    // Sections 1 and 2 measure the general terms, often on bare-king
+    // positions that Endgame::probe would otherwise score (see section 6).
+    g_ev.setSpecializedEndgames(false);
+
     std::cout << "========== SECTION 1: Material Values ==========\n\n";
     test_material_start_position();
     test_material_up_pawn();
@@ -377,18 +762,37 @@ int main() {
     test_pst_bishop_active_vs_corner();
     test_pst_rook_rank_2_bonus();
     test_pst_queen_center_vs_rim();
+    test_pst_king_tapers_with_phase();
+    test_activity_open_bishop_beats_blocked();
+    test_activity_pawn_fork_is_a_threat();
+    g_ev.setSpecializedEndgames(true);
 
     std::cout << "========== SECTION 3: Evaluator Properties ==========\n\n";
     test_property_perspective_negation();
     test_property_symmetry_all_pieces();
     test_property_score_bounded();
     test_property_equal_material_near_zero();
+    test_property_incremental_matches_scratch();
+    test_property_batch_matches_scalar();
+    test_property_coefficients_reproduce_eval();
+    test_set_parameter_rejects_out_of_range();
+    test_property_lazy_eval_bounds();
 
     std::cout << "========== SECTION 4: Terminal Detection ==========\n\n";
     test_terminal_checkmate();
     test_terminal_stalemate();
     test_terminal_non_terminal_returns_zero();
 
+    std::cout << "========== SECTION 5: Network Evaluation ==========\n\n";
+    test_nnue_rejects_bad_files();
+    test_nnue_incremental_matches_refresh();
+
+    std::cout << "========== SECTION 6: Endgames ==========\n\n";
+    test_endgame_kpk_bitbase();
+    test_endgame_mop_up_drives_king_to_edge();
+    test_endgame_kbnk_prefers_bishop_corner();
+    test_endgame_draws();
+
     std::cout << "\n========================================\n";
     std::cout << "ALL EVAL TESTS PASSED\n";
     return 0;
@@ -3,8 +3,10 @@
 #include <vector>
 #include <string>
 #include <algorithm>
-#include <cassert>
+#include <cstdlib>
 #include <chrono>
+#include <thread>
+#include <atomic>
 
 #include "search.h"
 #include "evaluator.h"
@@ -12,6 +14,15 @@
 #include "board.h"
 #include "move.h"
 
+// Unlike assert, stays on in release (NDEBUG) builds.
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << "FAIL [" << __FILE__ << ":" << __LINE__ << "]: " #cond "\n"; \
+			std::abort(); \
+		} \
+	} while (0)
+
 static constexpr int SEARCH_DEPTH = 5;
 
 struct SearchResult {
@@ -48,7 +59,7 @@ static void test_regression_best_move_updates_per_depth() {
 	Move move = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "b1h1" &&
+	CHECK(move.toString() == "b1h1" &&
 		"bestMove must be updated from currentBestMove at each depth");
 	std::cout << "PASS\n\n";
 }
@@ -61,7 +72,7 @@ static void test_qsearch_is_called() {
 		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 2);
 	std::cout << "  qNodes=" << r.stats.qNodes << "\n";
 
-	assert(r.stats.qNodes > 0 && "qsearch must be invoked at depth-0 leaves");
+	CHECK(r.stats.qNodes > 0 && "qsearch must be invoked at depth-0 leaves");
 	std::cout << "PASS\n\n";
 }
 
@@ -71,7 +82,19 @@ static void test_qsearch_captures_free_piece() {
 	Move move = run_search("4k3/8/8/4n3/8/8/8/4R2K w - - 0 1", SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "e1e5");
+	CHECK(move.toString() == "e1e5");
+	std::cout << "PASS\n\n";
+}
+
+// Unlike the position above, the knight is not pinned to its king, so it
+// escapes unless taken at once.
+static void test_qsearch_captures_unpinned_piece() {
+	std::cout << "--- test_qsearch_captures_unpinned_piece ---\n";
+
+	Move move = run_search("k7/8/8/4n3/8/8/8/4R2K w - - 0 1", SEARCH_DEPTH);
+	std::cout << "  move: " << move.toString() << "\n";
+
+	CHECK(move.toString() == "e1e5");
 	std::cout << "PASS\n\n";
 }
 
@@ -81,7 +104,7 @@ static void test_qsearch_avoids_losing_trade() {
 	Move move = run_search("3r4/8/8/3p4/2B5/8/8/4K2k w - - 0 1", SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() != "c4d5" &&
+	CHECK(move.toString() != "c4d5" &&
 		"qsearch must not take a piece when recapture wins material");
 	std::cout << "PASS\n\n";
 }
@@ -92,7 +115,7 @@ static void test_qsearch_resolves_capture_chain() {
 	Move move = run_search("k2r4/8/8/8/8/8/7K/3R4 w - - 0 1", SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "d1d8");
+	CHECK(move.toString() == "d1d8");
 	std::cout << "PASS\n\n";
 }
 
@@ -103,7 +126,7 @@ static void test_qsearch_includes_promotion_captures() {
 	Move move = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert((move.toString() == "g7h8Q" || move.toString() == "g7g8Q") &&
+	CHECK((move.toString() == "g7h8Q" || move.toString() == "g7g8Q") &&
 		"qsearch must include promotion-captures");
 	std::cout << "PASS\n\n";
 }
@@ -114,7 +137,7 @@ static void test_qsearch_stand_pat_quiet_position() {
 	SearchResult r = run_search_full("8/8/8/8/8/8/8/K6k w - - 0 1", 2);
 	std::cout << "  qNodes=" << r.stats.qNodes << "\n";
 
-	assert(r.stats.qNodes > 0);
+	CHECK(r.stats.qNodes > 0);
 	std::cout << "PASS\n\n";
 }
 
@@ -124,7 +147,7 @@ static void test_qsearch_no_horizon_effect() {
 	Move move = run_search("7r/8/8/7Q/8/8/8/4K2k w - - 0 1", 2);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "h5h8");
+	CHECK(move.toString() == "h5h8");
 	std::cout << "PASS\n\n";
 }
 
@@ -141,8 +164,8 @@ static void test_qsearch_node_fraction() {
 		<< "  qNodes=" << r.stats.qNodes
 		<< "  fraction=" << fraction << "\n";
 
-	assert(r.stats.qNodes > 20 && "qsearch must explore some nodes");
-	assert(fraction >= 0.10 && "qNodes should be ≥10 % of total nodes");
+	CHECK(r.stats.qNodes > 20 && "qsearch must explore some nodes");
+	CHECK(fraction >= 0.10 && "qNodes should be ≥10 % of total nodes");
 	std::cout << "PASS\n\n";
 }
 
@@ -156,7 +179,7 @@ static void test_ordering_tt_move_first() {
 	std::cout << "  firstMoveCutoffs=" << r.stats.firstMoveCutoffs
 		<< "  betaCutoffs=" << r.stats.betaCutoffs << "\n";
 
-	assert(r.move.isValid());
+	CHECK(r.move.isValid());
 	std::cout << "PASS\n\n";
 }
 
@@ -166,7 +189,7 @@ static void test_ordering_mvvlva() {
 	Move move = run_search("4k3/8/8/p3q3/4R3/8/8/4K3 w - - 0 1", SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "e4e5");
+	CHECK(move.toString() == "e4e5");
 	std::cout << "PASS\n\n";
 }
 
@@ -183,7 +206,7 @@ static void test_ordering_history_heuristic() {
 		double ratio = static_cast<double>(r.stats.firstMoveCutoffs) /
 			r.stats.betaCutoffs;
 		std::cout << "  first-move ratio=" << ratio << "\n";
-		assert(ratio >= 0.10 && "history heuristic should yield ≥10 % first-move cutoff ratio");
+		CHECK(ratio >= 0.10 && "history heuristic should yield ≥10 % first-move cutoff ratio");
 	}
 	std::cout << "PASS\n\n";
 }
@@ -208,7 +231,7 @@ static void test_coverage_mate_in_1_positions() {
 
 		std::cout << "  move=" << move.toString()
 			<< "  checkmate=" << (isMate ? "yes" : "no") << "\n";
-		assert(isMate && "engine must deliver checkmate in a mate-in-1 position");
+		CHECK(isMate && "engine must deliver checkmate in a mate-in-1 position");
 	}
 	std::cout << "PASS\n\n";
 }
@@ -219,7 +242,7 @@ static void test_coverage_mate_in_2_rook_cut() {
 	Move move = run_search("4r3/R7/6R1/8/8/5K2/8/6k1 w - - 0 1", std::max(4, SEARCH_DEPTH));
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert((move.toString() == "a7a1" || move.toString() == "a7g7"));
+	CHECK((move.toString() == "a7a1" || move.toString() == "a7g7"));
 	std::cout << "PASS\n\n";
 }
 
@@ -229,7 +252,7 @@ static void test_coverage_mate_in_3_back_rank() {
 	Move move = run_search("6k1/5ppp/8/8/8/8/1r6/2R1R1K1 w - - 0 1", std::max(5, SEARCH_DEPTH));
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert((move.toString() == "e1e8" || move.toString() == "c1c8"));
+	CHECK((move.toString() == "e1e8" || move.toString() == "c1c8"));
 	std::cout << "PASS\n\n";
 }
 
@@ -240,7 +263,7 @@ static void test_coverage_forced_check_evasion() {
 	Move move = run_search(fen, 1);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "a1b2" &&
+	CHECK(move.toString() == "a1b2" &&
 		"in check with one escape, engine must play the only legal move");
 	std::cout << "PASS\n\n";
 }
@@ -252,7 +275,7 @@ static void test_coverage_knight_fork() {
 	Move move = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() == "e4f6" &&
+	CHECK(move.toString() == "e4f6" &&
 		"Nf6+ must be found: it forks Kg8 and Re8");
 	std::cout << "PASS\n\n";
 }
@@ -264,7 +287,7 @@ static void test_coverage_stalemate_avoidance() {
 	Move move = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString() != "f7g6" && "Qg6 gives stalemate — must not be played");
+	CHECK(move.toString() != "f7g6" && "Qg6 gives stalemate — must not be played");
 	std::cout << "PASS\n\n";
 }
 
@@ -275,7 +298,7 @@ static void test_coverage_hanging_piece_defense() {
 	Move move = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  move: " << move.toString() << "\n";
 
-	assert(move.toString()[0] == 'd' &&
+	CHECK(move.toString()[0] == 'd' &&
 		"engine must move the queen off d4");
 	std::cout << "PASS\n\n";
 }
@@ -287,7 +310,7 @@ static void test_coverage_kk_returns_legal_move() {
 	SearchResult r = run_search_full("8/8/8/8/8/8/8/K6k w - - 0 1", SEARCH_DEPTH);
 	std::cout << "  move: " << r.move.toString() << "\n";
 
-	assert(r.move.isValid());
+	CHECK(r.move.isValid());
 	std::cout << "PASS\n\n";
 }
 
@@ -298,7 +321,7 @@ static void test_coverage_kk_score_near_zero() {
 	std::cout << "  totalNodes=" << r.stats.totalNodes
 		<< "  qNodes=" << r.stats.qNodes << "\n";
 
-	assert(r.stats.totalNodes < 200 &&
+	CHECK(r.stats.totalNodes < 200 &&
 		"K+K search must be tiny — no material to evaluate");
 	std::cout << "PASS\n\n";
 }
@@ -311,7 +334,7 @@ static void test_coverage_search_deterministic() {
 	Move m2 = run_search(fen, SEARCH_DEPTH);
 	std::cout << "  run1=" << m1.toString() << "  run2=" << m2.toString() << "\n";
 
-	assert(m1.toString() == m2.toString() &&
+	CHECK(m1.toString() == m2.toString() &&
 		"single-threaded search must be deterministic");
 	std::cout << "PASS\n\n";
 }
@@ -327,7 +350,398 @@ static void test_coverage_deeper_search_improves_quality() {
 	std::cout << "  depth1=" << shallow.toString()
 		<< "  depth4=" << deep.toString() << "\n";
 
-	assert(deep.toString() == "e4f6" && "depth-4 must find the winning fork");
+	CHECK(deep.toString() == "e4f6" && "depth-4 must find the winning fork");
+	std::cout << "PASS\n\n";
+}
+
+static void test_threadpool_reused_across_searches() {
+	std::cout << "--- test_threadpool_reused_across_searches ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(4);
+
+	const char* fen = "4r1k1/8/8/8/4N3/8/8/7K w - - 0 1";
+	for (int i = 0; i < 3; ++i) {
+		Board board;
+		board.loadFEN(fen);
+		Move m = search.findBestMove(board, SEARCH_DEPTH);
+		std::cout << "  run" << i << "=" << m.toString() << "\n";
+		CHECK(m.toString() == "e4f6" && "pooled helpers must not disturb the result");
+	}
+
+	search.setThreadCount(2);
+	CHECK(search.getThreadCount() == 2);
+	Board board;
+	board.loadFEN(fen);
+	Move m = search.findBestMove(board, SEARCH_DEPTH);
+	std::cout << "  after resize=" << m.toString() << "\n";
+	CHECK(m.toString() == "e4f6");
+
+	search.setThreadCount(1);
+	CHECK(search.getThreadCount() == 1);
+	std::cout << "PASS\n\n";
+}
+
+static void test_async_stop_ends_infinite_search() {
+	std::cout << "--- test_async_stop_ends_infinite_search ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(2);
+
+	Board board;
+	SearchLimits limits;
+	limits.infinite = true;
+
+	search.resetSignals();
+	std::atomic<bool> done{false};
+	Move result;
+	std::thread worker([&] {
+		result = search.findBestMove(board, limits);
+		done = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	CHECK(!done && "infinite search must not return before stop");
+
+	auto t0 = std::chrono::steady_clock::now();
+	search.stop();
+	worker.join();
+	long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - t0).count();
+	std::cout << "  move=" << result.toString() << "  stop latency=" << ms << "ms\n";
+
+	CHECK(result.isValid());
+	CHECK(ms < 1000 && "stop must end the search promptly");
+	std::cout << "PASS\n\n";
+}
+
+static void test_async_ponder_waits_for_ponderhit() {
+	std::cout << "--- test_async_ponder_waits_for_ponderhit ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	Board board;
+	SearchLimits limits;
+	limits.depth = 3;
+
+	search.resetSignals(/*ponder=*/true);
+	std::atomic<bool> done{false};
+	Move result;
+	std::thread worker([&] {
+		result = search.findBestMove(board, limits);
+		done = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	CHECK(!done && "a finished ponder search must hold bestmove until ponderhit");
+
+	search.ponderhit();
+	worker.join();
+	std::cout << "  move=" << result.toString()
+		<< "  ponder=" << search.getPonderMove().toString() << "\n";
+
+	CHECK(result.isValid());
+	std::cout << "PASS\n\n";
+}
+
+static void test_info_reported_per_iteration() {
+	std::cout << "--- test_info_reported_per_iteration ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	std::vector<SearchInfo> reports;
+	search.setInfoCallback([&](const SearchInfo& info) { reports.push_back(info); });
+
+	Board board;
+	board.loadFEN("4r1k1/8/8/8/4N3/8/8/7K w - - 0 1");
+	Move best = search.findBestMove(board, SEARCH_DEPTH);
+
+	std::cout << "  reports=" << reports.size() << "\n";
+	CHECK(static_cast<int>(reports.size()) == SEARCH_DEPTH && "one info line per completed iteration");
+	for (size_t i = 0; i < reports.size(); ++i) {
+		const SearchInfo& info = reports[i];
+		CHECK(info.depth == static_cast<int>(i) + 1);
+		CHECK(info.selDepth >= info.depth);
+		CHECK(!info.pv.empty() && static_cast<int>(info.pv.size()) <= info.depth);
+		if (i > 0) CHECK(info.nodes >= reports[i - 1].nodes);
+	}
+	CHECK(reports.back().pv.front() == best && "final pv must start with the best move");
+	std::cout << "PASS\n\n";
+}
+
+static void test_multipv_ranks_distinct_lines() {
+	std::cout << "--- test_multipv_ranks_distinct_lines ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+	search.setMultiPV(3);
+
+	std::vector<SearchInfo> lastDepth;
+	search.setInfoCallback([&](const SearchInfo& info) {
+		if (info.multiPV == 1) lastDepth.clear();
+		lastDepth.push_back(info);
+	});
+
+	Board board;
+	board.loadFEN("4r1k1/8/8/8/4N3/8/8/7K w - - 0 1");
+	Move best = search.findBestMove(board, SEARCH_DEPTH);
+
+	const auto& lines = search.getRootLines();
+	for (const auto& line : lines) {
+		std::cout << "  " << line.move.toString() << " " << line.score << "\n";
+	}
+
+	CHECK(lines.size() == 3);
+	CHECK(lines[0].move == best && best.toString() == "e4f6");
+	CHECK(!(lines[0].move == lines[1].move) && !(lines[1].move == lines[2].move)
+		&& !(lines[0].move == lines[2].move) && "lines must be distinct root moves");
+	CHECK(lines[0].score >= lines[1].score && lines[1].score >= lines[2].score);
+	CHECK(lastDepth.size() == 3 && lastDepth[2].multiPV == 3);
+	std::cout << "PASS\n\n";
+}
+
+static void test_lmr_table_shape() {
+	std::cout << "--- test_lmr_table_shape ---\n";
+
+	TranspositionTable tt(1);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	// Non-decreasing in both depth and move number; nothing for the first move.
+	for (int d = 1; d < 64; ++d) {
+		CHECK(search.lateMoveReduction(d, 1) == 0);
+		for (int m = 2; m < 64; ++m) {
+			CHECK(search.lateMoveReduction(d, m) >= search.lateMoveReduction(d, m - 1));
+			CHECK(search.lateMoveReduction(d, m) >= search.lateMoveReduction(d - 1, m));
+		}
+	}
+	CHECK(search.lateMoveReduction(20, 40) > search.lateMoveReduction(3, 5));
+
+	// A smaller divisor must reduce more; tunables rebuild the table.
+	const int before = search.lateMoveReduction(20, 40);
+	SearchParams params = search.getParams();
+	params.lmrDivisor /= 2;
+	search.setParams(params);
+	CHECK(search.lateMoveReduction(20, 40) > before);
+	std::cout << "PASS\n\n";
+}
+
+static void test_forward_pruning_engages() {
+	std::cout << "--- test_forward_pruning_engages ---\n";
+
+	// Quiet middlegame: plenty of nodes far outside the window.
+	auto r = run_search_full("r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N2N2/PP2BPPP/R2QKB1R w KQ - 0 8", 7);
+	std::cout << "  nodes=" << r.stats.totalNodes
+	          << " rfp=" << r.stats.rfpPrunes << " razor=" << r.stats.razorPrunes
+	          << " futility=" << r.stats.futilityPrunes << " lmp=" << r.stats.lmpPrunes << "\n";
+
+	CHECK(r.move.isValid());
+	CHECK(r.stats.rfpPrunes > 0 && "reverse futility never fired");
+	CHECK(r.stats.futilityPrunes + r.stats.lmpPrunes > 0 && "quiet-move pruning never fired");
+
+	// Pruning must not hide a forced win of material.
+	auto tactic = run_search_full("4r1k1/8/8/8/4N3/8/8/7K w - - 0 1", SEARCH_DEPTH);
+	CHECK(tactic.move.toString() == "e4f6");
+	std::cout << "PASS\n\n";
+}
+
+static void test_eval_cache_serves_repeats() {
+	std::cout << "--- test_eval_cache_serves_repeats ---\n";
+
+	auto r = run_search_full("r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N2N2/PP2BPPP/R2QKB1R w KQ - 0 8", 6);
+	std::cout << "  probes=" << r.stats.evalCacheProbes << " hits=" << r.stats.evalCacheHits << "\n";
+
+	CHECK(r.stats.evalCacheProbes > 0);
+	CHECK(r.stats.evalCacheHits > 0 && "transpositions never reached the eval cache");
+	CHECK(r.stats.evalCacheHits < r.stats.evalCacheProbes);
+	std::cout << "PASS\n\n";
+}
+
+static void test_lazy_eval_skips_lopsided_stand_pats() {
+	std::cout << "--- test_lazy_eval_skips_lopsided_stand_pats ---\n";
+
+	// White is a rook up, so most capture sequences end far outside the
+	// window and the stand-pat test needs no more than material and PST.
+	auto r = run_search_full("r1bqk3/pppp1ppp/2n2n2/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQq - 0 1", 6);
+	std::cout << "  probes=" << r.stats.lazyEvalProbes << " skips=" << r.stats.lazyEvalSkips << "\n";
+
+	CHECK(r.stats.lazyEvalProbes > 0);
+	CHECK(r.stats.lazyEvalSkips > 0 && "no stand-pat was decided lazily");
+	CHECK(r.stats.lazyEvalSkips < r.stats.lazyEvalProbes);
+	std::cout << "PASS\n\n";
+}
+
+static void test_endgame_mop_up_converts_krk() {
+	std::cout << "--- test_endgame_mop_up_converts_krk ---\n";
+
+	// Both sides play shallow searches from a centralised lone king. The
+	// mop-up evaluation has to supply the plan the search cannot see.
+	Board board;
+	board.loadFEN("8/8/8/4k3/8/8/8/R3K3 w - - 0 1");
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	int ply = 0;
+	while (ply < 40 && !board.generateLegalMoves().empty()) {
+		board.makeMove(search.findBestMove(board, 6, 0, 0));
+		++ply;
+	}
+	std::cout << "  plies=" << ply << "\n";
+
+	CHECK(board.isCheckmate(board.sideToMove()) && "KRK not mated within 20 moves");
+	std::cout << "PASS\n\n";
+}
+
+static void test_check_extension_finds_mate_earlier() {
+	std::cout << "--- test_check_extension_finds_mate_earlier ---\n";
+
+	// Queen and rook against a bare king. Without extensions the mate first
+	// shows at depth 6; extending the checking moves finds it by depth 4.
+	auto mateFoundAt4 = [](int maxExtensions) {
+		TranspositionTable tt(16);
+		Evaluator evaluator;
+		Search search(evaluator, tt);
+		search.setThreadCount(1);
+		SearchParams params;
+		params.maxExtensions = maxExtensions;
+		search.setParams(params);
+
+		Board board;
+		board.loadFEN("3k4/8/8/8/8/8/8/R2QK3 w - - 0 1");
+		search.findBestMove(board, 4);
+		std::cout << "  maxExtensions=" << maxExtensions
+		          << " score=" << search.getRootLines()[0].score
+		          << " checkExt=" << search.getStats().checkExtensions << "\n";
+		return search.getRootLines()[0].score > Search::MATE_SCORE - 100;
+	};
+
+	CHECK(!mateFoundAt4(0) && "position no longer needs an extension; pick a harder one");
+	CHECK(mateFoundAt4(SearchParams{}.maxExtensions));
+	std::cout << "PASS\n\n";
+}
+
+static void test_node_limit_is_deterministic() {
+	std::cout << "--- test_node_limit_is_deterministic ---\n";
+
+	const uint64_t budget = 20000;
+	auto run = [&](Move& best) {
+		TranspositionTable tt(16);
+		Evaluator evaluator;
+		Search search(evaluator, tt);
+		search.setThreadCount(1);
+
+		Board board;
+		board.loadFEN("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 0 1");
+		SearchLimits limits;
+		limits.nodes = budget;
+		search.resetSignals();
+		best = search.findBestMove(board, limits);
+		return search.getNodes();
+	};
+
+	Move m1, m2;
+	const uint64_t n1 = run(m1);
+	const uint64_t n2 = run(m2);
+	std::cout << "  run1=" << m1.toString() << " nodes=" << n1
+		<< "  run2=" << m2.toString() << " nodes=" << n2 << "\n";
+
+	CHECK(n1 == n2 && m1 == m2 && "a node budget must give the same search every run");
+	CHECK(n1 >= budget && n1 < budget + 4096 && "the budget is checked every few thousand nodes");
+	std::cout << "PASS\n\n";
+}
+
+static void test_mate_search_stops_when_proven() {
+	std::cout << "--- test_mate_search_stops_when_proven ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	int lastDepth = 0;
+	search.setInfoCallback([&](const SearchInfo& info) { lastDepth = info.depth; });
+
+	Board board;
+	board.loadFEN("4r3/R7/6R1/8/8/5K2/8/6k1 w - - 0 1");
+	SearchLimits limits;
+	limits.mate = 2;
+	search.resetSignals();
+	Move move = search.findBestMove(board, limits);
+	const int score = search.getRootLines()[0].score;
+	std::cout << "  move=" << move.toString() << " score=" << score << " depth=" << lastDepth << "\n";
+
+	CHECK(score == Search::MATE_SCORE - 3 && "mate in 2 is three plies away");
+	CHECK(lastDepth <= 6 && "search must return as soon as the mate is proven");
+	std::cout << "PASS\n\n";
+}
+
+static void test_mate_search_gives_up_without_mate() {
+	std::cout << "--- test_mate_search_gives_up_without_mate ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(1);
+
+	int lastDepth = 0;
+	search.setInfoCallback([&](const SearchInfo& info) { lastDepth = info.depth; });
+
+	// Opening position: no mate in 1, so the search has to end on depth alone.
+	Board board;
+	board.loadFEN("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 0 1");
+	SearchLimits limits;
+	limits.mate = 1;
+	search.resetSignals();
+	auto t0 = std::chrono::steady_clock::now();
+	Move move = search.findBestMove(board, limits);
+	auto t1 = std::chrono::steady_clock::now();
+	long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+	std::cout << "  move=" << move.toString() << " depth=" << lastDepth << " ms=" << ms << "\n";
+
+	CHECK(move.isValid());
+	CHECK(lastDepth > 0 && lastDepth <= 8 && "go mate 1 must not keep deepening");
+	CHECK(search.getRootLines()[0].score < Search::MATE_SCORE - 1);
+	std::cout << "PASS\n\n";
+}
+
+static void test_root_split_agrees_with_single_thread() {
+	std::cout << "--- test_root_split_agrees_with_single_thread ---\n";
+
+	TranspositionTable tt(16);
+	Evaluator evaluator;
+	Search search(evaluator, tt);
+	search.setThreadCount(4);
+	search.setRootSplit(true);
+
+	struct Case { const char* fen; int depth; std::vector<std::string> best; };
+	const Case cases[] = {
+		{"4r1k1/8/8/8/4N3/8/8/7K w - - 0 1", SEARCH_DEPTH, {"e4f6"}},
+		{"4r3/R7/6R1/8/8/5K2/8/6k1 w - - 0 1", 4, {"a7a1", "a7g7", "a7h7"}},  // all mate in 2
+	};
+	for (const auto& c : cases) {
+		tt.clear();
+		Board board;
+		board.loadFEN(c.fen);
+		Move m = search.findBestMove(board, c.depth);
+		std::cout << "  " << c.fen << " -> " << m.toString() << "\n";
+		CHECK(std::find(c.best.begin(), c.best.end(), m.toString()) != c.best.end()
+			&& "split root search must find the same best move");
+	}
 	std::cout << "PASS\n\n";
 }
 
@@ -338,6 +752,7 @@ int main() {
 	std::cout << "========== SECTION 2: Quiescence Search ==========\n\n";
 	test_qsearch_is_called();
 	test_qsearch_captures_free_piece();
+	test_qsearch_captures_unpinned_piece();
 	test_qsearch_avoids_losing_trade();
 	test_qsearch_resolves_capture_chain();
 	test_qsearch_includes_promotion_captures();
@@ -349,6 +764,7 @@ int main() {
 	test_ordering_tt_move_first();
 	test_ordering_mvvlva();
 	test_ordering_history_heuristic();
+	test_lmr_table_shape();
 
 	std::cout << "========== SECTION 4: Correctness Coverage ==========\n\n";
 	test_coverage_mate_in_1_positions();
@@ -361,7 +777,27 @@ int main() {
 	test_coverage_kk_returns_legal_move();
 	test_coverage_kk_score_near_zero();
 	test_coverage_search_deterministic();
+	test_node_limit_is_deterministic();
+	test_mate_search_stops_when_proven();
+	test_mate_search_gives_up_without_mate();
 	test_coverage_deeper_search_improves_quality();
+	test_forward_pruning_engages();
+	test_eval_cache_serves_repeats();
+	test_lazy_eval_skips_lopsided_stand_pats();
+	test_check_extension_finds_mate_earlier();
+	test_endgame_mop_up_converts_krk();
+
+	std::cout << "========== SECTION 5: Thread Pool ==========\n\n";
+	test_threadpool_reused_across_searches();
+	test_root_split_agrees_with_single_thread();
+
+	std::cout << "========== SECTION 6: Async Control ==========\n\n";
+	test_async_stop_ends_infinite_search();
+	test_async_ponder_waits_for_ponderhit();
+
+	std::cout << "========== SECTION 7: Progress Reporting ==========\n\n";
+	test_info_reported_per_iteration();
+	test_multipv_ranks_distinct_lines();
 
 	std::cout << "\n========================================\n";
 	std::cout << "ALL SEARCH LOGIC TESTS PASSED\n";
@@ -257,6 +257,23 @@ static void test_valid_move_overwrites_stored_move() {
 	std::cout << "PASS\n\n";
 }
 
+static void test_new_key_without_move_clears_stored_move() {
+	std::cout << "--- test_new_key_without_move_clears_stored_move ---\n";
+	TranspositionTable tt(1);
+	size_t numEntries = (1ULL * 1024 * 1024) / sizeof(TranspositionTable::TTEntry);
+	uint64_t key1 = 0x9999;
+	uint64_t key2 = key1 + numEntries;
+
+	tt.store(key1, 50, 3, mv("e2e4"), TranspositionTable::EXACT);
+	tt.store(key2, 80, 5, Move(), TranspositionTable::LOWERBOUND);
+
+	TranspositionTable::TTEntry out;
+	bool found = tt.probe(key2, out);
+	REQUIRE(found);
+	REQUIRE_MSG(out.bestMove == Move(), "a colliding key must not inherit the evicted entry's bestMove");
+	std::cout << "PASS\n\n";
+}
+
 static void test_exact_flag_enables_direct_return() {
 	std::cout << "--- test_exact_flag_enables_direct_return ---\n";
 	TranspositionTable tt(1);
@@ -466,6 +483,7 @@ int main() {
 	std::cout << "========== SECTION 4: Move Preservation ==========\n\n";
 	test_invalid_move_does_not_overwrite_stored_move();
 	test_valid_move_overwrites_stored_move();
+	test_new_key_without_move_clears_stored_move();
 
 	std::cout << "========== SECTION 5: Flag / Depth Semantics ==========\n\n";
 	test_exact_flag_enables_direct_return();